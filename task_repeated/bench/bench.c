@@ -0,0 +1,385 @@
+// bench.c
+// One harness for the numerical kernels of the tasks: every kernel is an
+// entry of the registry below (setup / run / work counts) and is timed the
+// same way for a sweep of working-set sizes from L1-resident to DRAM.
+//
+// Per (kernel, size): one untimed call (first touch), then the number of
+// calls per repetition is chosen so a repetition lasts >= min_time; warmup
+// repetitions are discarded and reps repetitions are timed. Reported per
+// call: median, mean +- 95% confidence interval of the mean
+// (../common/bench.h); ns per element, GB/s (compulsory traffic) and GFLOP/s
+// from the median. --json writes the bench_write_json format shared with the
+// task programs (scaling "sweep", workers = threads of daxpy_omp, else 1).
+//
+// Build:  make            (FFT kernel when FFTW is found, see Makefile)
+// Run:    ./bench [--kernels k1,k2] [--sizes 32K,256K,4M,64M] [--reps 10]
+//                 [--warmup 3] [--min-time 0.01] [--json out.json]
+//                 [--compare baseline.json] [--tol 0.05] [--list]
+//   --compare matches (kernel, workers, n) with a stored --json run
+//   (bench_compare_json); a point is "slower"/"faster" only if the confidence
+//   intervals separate and the means differ by more than tol. Exit code 2 if
+//   anything got slower, 1 if the baseline cannot be read.
+//   make baseline / make compare wrap this.
+//
+// Kernels (elements / bytes / flops per call):
+//   daxpy, daxpy_novec, daxpy_omp  y = a x + y        n / 24n / 2n
+//   sum_naive, sum_lanes, sum_neumaier, sum_pairwise, sum_repro, sum_exact
+//                                  sum(x), ../common  n / 8n / n
+//   trapezoid                      h (y0/2 + y1 + ... + yn-1/2)  n / 8n / n
+//   gemm_ikj, gemm_tiled           C = A B, n x n     n^3 / 24n^2 / 2n^3
+//   fft_r2c                        2D r2c, n x n      n^2 / 16n^2 / 5n^2 log2 n^2
+//                                  (n rounded up to 7-smooth, ../task6/fft2.h)
+
+#define _POSIX_C_SOURCE 200809L   // fft2.h: gethostname
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+#include "../common/bench.h"
+#include "../common/sumlib.h"
+#include "../common/repro_sum.h"
+#include "../common/exactsum.h"
+#include "../common/cbrng.h"
+#ifdef HAVE_FFTW
+#include "../task6/fft2.h"
+#endif
+
+typedef struct {
+    size_t n;
+    double *x, *y, *z;
+    double a;
+#ifdef HAVE_FFTW
+    fftw_plan plan;
+    int fftw_bufs;       // x, z from fftw_alloc_*
+#endif
+} bstate;
+
+// Results of the sum kernels go here so the calls are not optimized away
+static volatile double sink;
+
+typedef struct {
+    const char *name;
+    size_t (*size)(size_t ws);                        // working set bytes -> n (0 = skip)
+    void (*work)(size_t n, double *elems, double *bytes, double *flops);
+    int (*setup)(bstate *s, size_t n);
+    void (*run)(bstate *s);
+} kernel;
+
+// ---- sizes and work counts ----
+static size_t size_vec1(size_t ws) { return ws / 8; }
+static size_t size_vec2(size_t ws) { return ws / 16; }
+static size_t size_gemm(size_t ws) {
+    size_t n = (size_t)sqrt((double)ws / 24.0);
+    return (n >= 8 && n <= 768) ? n : 0;              // 2 n^3 flops get long quickly
+}
+
+static void work_axpy(size_t n, double *e, double *b, double *f) { *e = (double)n; *b = 24.0 * n; *f = 2.0 * n; }
+static void work_sum(size_t n, double *e, double *b, double *f)  { *e = (double)n; *b = 8.0 * n;  *f = (double)n; }
+static void work_gemm(size_t n, double *e, double *b, double *f) {
+    double m = (double)n;
+    *e = m * m * m; *b = 24.0 * m * m; *f = 2.0 * m * m * m;
+}
+
+// ---- setup ----
+static int setup_vec(bstate *s, size_t n, int arrays) {
+    s->n = n;
+    s->a = 1e-3;
+    s->x = (double*) malloc(n * sizeof(double));
+    s->y = (arrays > 1) ? (double*) malloc(n * sizeof(double)) : NULL;
+    if (!s->x || (arrays > 1 && !s->y)) return -1;
+    cbrng_fill_uniform(42, 0, 0, n, s->x);
+    if (s->y) cbrng_fill_uniform(42, 1, 0, n, s->y);
+    return 0;
+}
+static int setup_x(bstate *s, size_t n)  { return setup_vec(s, n, 1); }
+static int setup_xy(bstate *s, size_t n) { return setup_vec(s, n, 2); }
+
+static int setup_gemm(bstate *s, size_t n) {
+    if (setup_vec(s, n * n, 2) != 0) return -1;
+    s->n = n;
+    s->z = (double*) malloc(n * n * sizeof(double));
+    return s->z ? 0 : -1;
+}
+
+// ---- kernels ----
+static void run_daxpy(bstate *s) {
+    const double a = s->a, *x = s->x;
+    double *y = s->y;
+    for (size_t i = 0; i < s->n; ++i) y[i] = a * x[i] + y[i];
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("no-tree-vectorize")))
+#endif
+static void run_daxpy_novec(bstate *s) {
+    const double a = s->a, *x = s->x;
+    double *y = s->y;
+    for (size_t i = 0; i < s->n; ++i) y[i] = a * x[i] + y[i];
+}
+
+static void run_daxpy_omp(bstate *s) {
+    const double a = s->a, *x = s->x;
+    double *y = s->y;
+    const long long n = (long long)s->n;
+    #pragma omp parallel for simd schedule(static)
+    for (long long i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+}
+
+static void run_sum_naive(bstate *s) {
+    double r = 0.0;
+    for (size_t i = 0; i < s->n; ++i) r += s->x[i];
+    sink = r;
+}
+static void run_sum_lanes(bstate *s)    { sink = sum_lanes(s->x, s->n); }
+static void run_sum_neumaier(bstate *s) { sink = sum_neumaier_simd(s->x, s->n); }
+static void run_sum_pairwise(bstate *s) { sink = sum_pairwise(s->x, s->n); }
+static void run_sum_repro(bstate *s)    { sink = repro_sum(s->x, s->n); }
+static void run_sum_exact(bstate *s)    { sink = xsum_exact(s->x, s->n); }
+
+static void run_trapezoid(bstate *s) {
+    const double *y = s->x, h = 1.0 / (double)(s->n - 1);
+    const size_t last = s->n - 1;
+    double r = 0.0;
+    #pragma omp simd reduction(+:r)
+    for (size_t i = 1; i < last; ++i) r += y[i];
+    sink = h * (r + 0.5 * (y[0] + y[s->n - 1]));
+}
+
+// C = A B, row-major: row i of C accumulates a_ik * row k of B (unit stride)
+static void run_gemm_ikj(bstate *s) {
+    const size_t n = s->n;
+    const double *A = s->x, *B = s->y;
+    double *C = s->z;
+    memset(C, 0, n * n * sizeof(double));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = 0; k < n; ++k) {
+            const double aik = A[i * n + k];
+            for (size_t j = 0; j < n; ++j) C[i * n + j] += aik * B[k * n + j];
+        }
+}
+
+// Same loop order on 64 x 64 tiles: a tile of B is reused from L1/L2
+#define GEMM_TILE 64
+static void run_gemm_tiled(bstate *s) {
+    const size_t n = s->n;
+    const double *A = s->x, *B = s->y;
+    double *C = s->z;
+    memset(C, 0, n * n * sizeof(double));
+    for (size_t ii = 0; ii < n; ii += GEMM_TILE)
+        for (size_t kk = 0; kk < n; kk += GEMM_TILE)
+            for (size_t jj = 0; jj < n; jj += GEMM_TILE) {
+                size_t ie = (ii + GEMM_TILE < n) ? ii + GEMM_TILE : n;
+                size_t ke = (kk + GEMM_TILE < n) ? kk + GEMM_TILE : n;
+                size_t je = (jj + GEMM_TILE < n) ? jj + GEMM_TILE : n;
+                for (size_t i = ii; i < ie; ++i)
+                    for (size_t k = kk; k < ke; ++k) {
+                        const double aik = A[i * n + k];
+                        for (size_t j = jj; j < je; ++j) C[i * n + j] += aik * B[k * n + j];
+                    }
+            }
+}
+
+#ifdef HAVE_FFTW
+// sqrt(ws/16) is often a bad radix (2M -> 362 = 2 * 181): take the next
+// 7-smooth size so the sweep shows working-set effects, not factorizations
+static size_t size_fft(size_t ws) {
+    size_t n = (size_t)sqrt((double)ws / 16.0);
+    return (n >= 8) ? (size_t)fft2_next_smooth((int)n, 7) : 0;
+}
+static void work_fft(size_t n, double *e, double *b, double *f) {
+    double m = (double)n * n;
+    *e = m; *b = 16.0 * m; *f = 5.0 * m * log2(m);
+}
+static int setup_fft(bstate *s, size_t n) {
+    s->n = n;
+    s->fftw_bufs = 1;
+    s->x = fftw_alloc_real(n * n);
+    s->z = (double*) fftw_alloc_complex(n * (n / 2 + 1));
+    if (!s->x || !s->z) return -1;
+    s->plan = fftw_plan_dft_r2c_2d((int)n, (int)n, s->x, (fftw_complex*) s->z, FFTW_MEASURE);
+    if (!s->plan) return -1;
+    cbrng_fill_uniform(42, 0, 0, n * n, s->x);   // after planning: MEASURE overwrites
+    return 0;
+}
+static void run_fft(bstate *s) { fftw_execute(s->plan); }
+#endif
+
+static const kernel registry[] = {
+    { "daxpy",        size_vec2, work_axpy, setup_xy,   run_daxpy },
+    { "daxpy_novec",  size_vec2, work_axpy, setup_xy,   run_daxpy_novec },
+    { "daxpy_omp",    size_vec2, work_axpy, setup_xy,   run_daxpy_omp },
+    { "sum_naive",    size_vec1, work_sum,  setup_x,    run_sum_naive },
+    { "sum_lanes",    size_vec1, work_sum,  setup_x,    run_sum_lanes },
+    { "sum_neumaier", size_vec1, work_sum,  setup_x,    run_sum_neumaier },
+    { "sum_pairwise", size_vec1, work_sum,  setup_x,    run_sum_pairwise },
+    { "sum_repro",    size_vec1, work_sum,  setup_x,    run_sum_repro },
+    { "sum_exact",    size_vec1, work_sum,  setup_x,    run_sum_exact },
+    { "trapezoid",    size_vec1, work_sum,  setup_x,    run_trapezoid },
+    { "gemm_ikj",     size_gemm, work_gemm, setup_gemm, run_gemm_ikj },
+    { "gemm_tiled",   size_gemm, work_gemm, setup_gemm, run_gemm_tiled },
+#ifdef HAVE_FFTW
+    { "fft_r2c",      size_fft,  work_fft,  setup_fft,  run_fft },
+#endif
+};
+#define NKERNELS (sizeof registry / sizeof registry[0])
+
+static void teardown(bstate *s) {
+#ifdef HAVE_FFTW
+    if (s->fftw_bufs) {
+        if (s->plan) fftw_destroy_plan(s->plan);
+        fftw_free(s->x);
+        fftw_free(s->z);
+        memset(s, 0, sizeof *s);
+        return;
+    }
+#endif
+    free(s->x);
+    free(s->y);
+    free(s->z);
+    memset(s, 0, sizeof *s);
+}
+
+// ---- timing ----
+typedef struct { int reps, warmup; double min_time; } options;
+
+// Fills r (times per call) and *ns_elem; returns 1 if ws does not apply.
+static int measure(const kernel *k, size_t ws, const options *o, bench_row *r, double *ns_elem) {
+    size_t n = k->size(ws);
+    if (n == 0) return 1;
+    bstate s;
+    memset(&s, 0, sizeof s);
+    if (k->setup(&s, n) != 0) { teardown(&s); return -1; }
+
+    double t0 = bench_now();
+    k->run(&s);                                       // first touch, caches, page faults
+    double t1 = bench_now() - t0;
+    long inner = (t1 > 0.0) ? (long)ceil(o->min_time / t1) : 1000;
+    if (inner < 1) inner = 1;
+
+    double *t = (double*) malloc((size_t)o->reps * sizeof(double));
+    if (!t) { teardown(&s); return -1; }
+    for (int rep = -o->warmup; rep < o->reps; ++rep) {
+        t0 = bench_now();
+        for (long c = 0; c < inner; ++c) k->run(&s);
+        double dt = (bench_now() - t0) / (double)inner;
+        if (rep >= 0) t[rep] = dt;
+    }
+    bench_stats_compute(t, o->reps, &r->t);
+    free(t);
+
+    double e, b, f;
+    k->work(n, &e, &b, &f);
+    r->program = "bench";
+    r->kernel = k->name;
+    r->scaling = "sweep";
+    r->workers = 1;
+#ifdef _OPENMP
+    if (k->run == run_daxpy_omp) r->workers = omp_get_max_threads();
+#endif
+    r->n = n;
+    r->bytes = b;
+    r->flops = f;
+    r->gbps = b / r->t.median * 1e-9;
+    r->gflops = f / r->t.median * 1e-9;
+    *ns_elem = 1e9 * r->t.median / e;
+    teardown(&s);
+    return 0;
+}
+
+// ---- command line ----
+// "32K", "4M", "1G" (powers of 1024) or plain bytes
+static int parse_ws(const char *list, size_t *out, int max) {
+    int k = 0;
+    const char *p = list;
+    while (*p && k < max) {
+        char *end = NULL;
+        double v = strtod(p, &end);
+        if (end == p) break;
+        if (*end == 'K' || *end == 'k') { v *= 1024.0; ++end; }
+        else if (*end == 'M' || *end == 'm') { v *= 1048576.0; ++end; }
+        else if (*end == 'G' || *end == 'g') { v *= 1073741824.0; ++end; }
+        if (v >= 64.0) out[k++] = (size_t)v;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',') break;
+    }
+    return k;
+}
+
+static int selected(const char *list, const char *name) {
+    if (!list) return 1;
+    size_t len = strlen(name);
+    for (const char *p = list; (p = strstr(p, name)) != NULL; p += len)
+        if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) return 1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    options o = { 10, 3, 0.01 };
+    const char *kernels = NULL, *sizes = "32K,256K,2M,16M,128M", *json = NULL, *base = NULL;
+    double tol = 0.05;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i], *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!strcmp(a, "--list")) {
+            for (size_t k = 0; k < NKERNELS; ++k) printf("%s\n", registry[k].name);
+            return 0;
+        }
+        if (!v) { fprintf(stderr, "%s needs a value (see the header of bench.c)\n", a); return 1; }
+        if (!strcmp(a, "--kernels")) kernels = v;
+        else if (!strcmp(a, "--sizes")) sizes = v;
+        else if (!strcmp(a, "--reps")) o.reps = atoi(v);
+        else if (!strcmp(a, "--warmup")) o.warmup = atoi(v);
+        else if (!strcmp(a, "--min-time")) o.min_time = atof(v);
+        else if (!strcmp(a, "--json")) json = v;
+        else if (!strcmp(a, "--compare")) base = v;
+        else if (!strcmp(a, "--tol")) tol = atof(v);
+        else { fprintf(stderr, "Unknown option %s\n", a); return 1; }
+        ++i;
+    }
+    if (o.reps < 2) o.reps = 2;
+    if (o.warmup < 0) o.warmup = 0;
+
+    size_t ws[32];
+    int nws = parse_ws(sizes, ws, 32);
+    if (nws == 0) { fprintf(stderr, "No sizes in '%s'\n", sizes); return 1; }
+    bench_row *res = (bench_row*) calloc(NKERNELS * (size_t)nws, sizeof(bench_row));
+    if (!res) { perror("calloc"); return 1; }
+    int nr = 0;
+
+#ifdef _OPENMP
+    printf("bench: %d threads (daxpy_omp), ", omp_get_max_threads());
+#else
+    printf("bench: serial build, ");
+#endif
+    printf("%d warm-up + %d timed repetitions of >= %g s\n", o.warmup, o.reps, o.min_time);
+    printf("%-14s %9s %10s %12s %12s %12s %10s %9s %9s\n", "kernel", "ws", "n", "median[s]", "mean[s]",
+           "+-ci95(mean)", "ns/elem", "GB/s", "GFLOP/s");
+    for (size_t k = 0; k < NKERNELS; ++k) {
+        if (!selected(kernels, registry[k].name)) continue;
+        for (int w = 0; w < nws; ++w) {
+            double ns_elem = 0.0;
+            int rc = measure(&registry[k], ws[w], &o, &res[nr], &ns_elem);
+            if (rc > 0) continue;                     // size not applicable
+            if (rc < 0) { fprintf(stderr, "%s: setup failed at %zu bytes\n", registry[k].name, ws[w]); continue; }
+            const bench_row *r = &res[nr++];
+            printf("%-14s %8.0fK %10zu %12.4e %12.4e %12.2e %10.4f %9.2f %9.2f\n", r->kernel,
+                   (double)ws[w] / 1024.0, r->n, r->t.median, r->t.mean, bench_ci95(&r->t), ns_elem, r->gbps,
+                   r->gflops);
+        }
+    }
+
+    int rc = 0;
+    if (json && bench_write_json(json, res, nr) == 0) printf("Wrote %s\n", json);
+    if (base) {
+        int slower = bench_compare_json(base, res, nr, tol);
+        rc = (slower < 0) ? 1 : (slower > 0) ? 2 : 0;
+    }
+    free(res);
+    return rc;
+}
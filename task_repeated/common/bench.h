@@ -0,0 +1,212 @@
+// bench.h
+// Small helpers for repeated timings: a wall clock, summary statistics over
+// the repetitions of one benchmark point, CSV / JSON output of a table of such
+// points and a comparison of a table with a stored JSON run.
+// Header-only so every task program can include it with a relative path.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Wall-clock seconds (C11 timespec_get), for differences only.
+static inline double bench_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+typedef struct {
+    int    n;        // number of timed repetitions
+    double median;   // seconds
+    double min;
+    double max;
+    double mean;
+    double stddev;   // sample standard deviation
+} bench_stats;
+
+// One measured point of a sweep.
+typedef struct {
+    const char *program;  // e.g. "task9_openmp"
+    const char *kernel;   // e.g. "add"
+    const char *scaling;  // "strong", "weak" or "sweep" (working-set sweep)
+    int    workers;       // threads or ranks
+    size_t n;             // total elements
+    double bytes;         // bytes moved per repetition (for GB/s)
+    double flops;         // flops per repetition (0 = not counted)
+    bench_stats t;
+    double gbps;          // bytes / median
+    double gflops;        // flops / median
+    double efficiency;    // parallel efficiency vs workers == 1
+} bench_row;
+
+static int bench_cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Fills s from the n samples in t (t is sorted in place).
+static inline void bench_stats_compute(double *t, int n, bench_stats *s) {
+    memset(s, 0, sizeof(*s));
+    s->n = n;
+    if (n <= 0) return;
+    qsort(t, (size_t)n, sizeof(double), bench_cmp_double);
+    s->min = t[0];
+    s->max = t[n - 1];
+    s->median = (n % 2) ? t[n / 2] : 0.5 * (t[n / 2 - 1] + t[n / 2]);
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += t[i];
+    s->mean = sum / n;
+    double ss = 0.0;
+    for (int i = 0; i < n; ++i) ss += (t[i] - s->mean) * (t[i] - s->mean);
+    s->stddev = (n > 1) ? sqrt(ss / (n - 1)) : 0.0;
+}
+
+// Half-width of the 95% confidence interval of the mean (Student t with
+// n-1 degrees of freedom): the mean is mean +- bench_ci95(s).
+static inline double bench_ci95(const bench_stats *s) {
+    static const double t975[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (s->n < 2) return 0.0;
+    double t = (s->n - 1 <= 30) ? t975[s->n - 2] : 1.960;
+    return t * s->stddev / sqrt((double)s->n);
+}
+
+// Parses "1000000,1e7,2.5e7" into out[] (at most max entries).
+// Returns the number of values read.
+static inline int bench_parse_sizes(const char *list, size_t *out, int max) {
+    int k = 0;
+    const char *p = list;
+    while (*p && k < max) {
+        char *end = NULL;
+        double v = strtod(p, &end);
+        if (end == p) break;
+        if (v >= 1.0) out[k++] = (size_t)v;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',') break;
+    }
+    return k;
+}
+
+static inline void bench_print_header(void) {
+    printf("%-8s %7s %12s %11s %11s %10s %9s %7s\n",
+           "scaling", "workers", "N", "median[s]", "min[s]", "stddev[s]", "GB/s", "eff");
+}
+
+static inline void bench_print_row(const bench_row *r) {
+    printf("%-8s %7d %12zu %11.6f %11.6f %10.2e %9.2f %6.1f%%\n",
+           r->scaling, r->workers, r->n, r->t.median, r->t.min, r->t.stddev,
+           r->gbps, 100.0 * r->efficiency);
+}
+
+// Writes <path> as CSV (one line per row). Returns 0 on success.
+static inline int bench_write_csv(const char *path, const bench_row *rows, int nrows) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) { perror(path); return -1; }
+    fprintf(fp, "program,kernel,scaling,workers,n,reps,median_s,min_s,max_s,mean_s,stddev_s,gbps,gflops,efficiency\n");
+    for (int i = 0; i < nrows; ++i) {
+        const bench_row *r = &rows[i];
+        fprintf(fp, "%s,%s,%s,%d,%zu,%d,%.9e,%.9e,%.9e,%.9e,%.9e,%.6f,%.6f,%.6f\n",
+                r->program, r->kernel, r->scaling, r->workers, r->n, r->t.n,
+                r->t.median, r->t.min, r->t.max, r->t.mean, r->t.stddev,
+                r->gbps, r->gflops, r->efficiency);
+    }
+    fclose(fp);
+    return 0;
+}
+
+// Writes <path> as a JSON array of objects with the same fields as the CSV.
+static inline int bench_write_json(const char *path, const bench_row *rows, int nrows) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) { perror(path); return -1; }
+    fprintf(fp, "[\n");
+    for (int i = 0; i < nrows; ++i) {
+        const bench_row *r = &rows[i];
+        fprintf(fp, "  {\"program\": \"%s\", \"kernel\": \"%s\", \"scaling\": \"%s\", "
+                    "\"workers\": %d, \"n\": %zu, \"reps\": %d, "
+                    "\"median_s\": %.9e, \"min_s\": %.9e, \"max_s\": %.9e, "
+                    "\"mean_s\": %.9e, \"stddev_s\": %.9e, "
+                    "\"gbps\": %.6f, \"gflops\": %.6f, \"efficiency\": %.6f}%s\n",
+                r->program, r->kernel, r->scaling, r->workers, r->n, r->t.n,
+                r->t.median, r->t.min, r->t.max, r->t.mean, r->t.stddev,
+                r->gbps, r->gflops, r->efficiency, (i + 1 < nrows) ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    fclose(fp);
+    return 0;
+}
+
+// Field lookups in one object [obj, end) of a bench_write_json file.
+static inline int bench_json_num(const char *obj, const char *end, const char *key, double *v) {
+    char pat[64];
+    snprintf(pat, sizeof pat, "\"%s\": ", key);
+    const char *p = strstr(obj, pat);
+    return p && p < end && sscanf(p + strlen(pat), "%lf", v) == 1;
+}
+
+static inline int bench_json_is(const char *obj, const char *end, const char *key, const char *val) {
+    char pat[64];
+    snprintf(pat, sizeof pat, "\"%s\": \"", key);
+    const char *p = strstr(obj, pat);
+    if (!p || p >= end) return 0;
+    p += strlen(pat);
+    size_t len = strlen(val);
+    return strncmp(p, val, len) == 0 && p[len] == '"';
+}
+
+// Compares rows with a file written by bench_write_json, matching program,
+// kernel, workers and n. A point is "SLOWER"/"faster" only if the 95%
+// confidence intervals of the two means separate and the means differ by
+// more than tol (relative). Prints one line per matched point and returns
+// the number of slower points, or -1 if the file cannot be read.
+static inline int bench_compare_json(const char *path, const bench_row *rows, int nrows, double tol) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) { perror(path); return -1; }
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *buf = (len >= 0) ? (char*) malloc((size_t)len + 1) : NULL;
+    if (!buf || fread(buf, 1, (size_t)len, fp) != (size_t)len) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(fp); free(buf); return -1;
+    }
+    buf[len] = '\0';
+    fclose(fp);
+
+    int slower = 0, faster = 0, matched = 0;
+    printf("\nCompare with %s (tol %.0f%%, 95%% CIs):\n", path, 100.0 * tol);
+    printf("%-14s %7s %10s %14s %14s %8s  %s\n", "kernel", "workers", "n", "base[s]", "now[s]", "speedup", "verdict");
+    for (const char *p = strchr(buf, '{'); p; p = strchr(p + 1, '{')) {
+        const char *end = strchr(p, '}');
+        double n, workers, reps, mean, sd;
+        if (!end || !bench_json_num(p, end, "n", &n) || !bench_json_num(p, end, "workers", &workers) ||
+            !bench_json_num(p, end, "reps", &reps) || !bench_json_num(p, end, "mean_s", &mean) ||
+            !bench_json_num(p, end, "stddev_s", &sd)) continue;
+        bench_stats b = { (int)reps, 0.0, 0.0, 0.0, mean, sd };
+        double ci = bench_ci95(&b);
+        for (int i = 0; i < nrows; ++i) {
+            const bench_row *r = &rows[i];
+            if ((double)r->n != n || (double)r->workers != workers || !bench_json_is(p, end, "program", r->program) ||
+                !bench_json_is(p, end, "kernel", r->kernel)) continue;
+            double now = r->t.mean, now_ci = bench_ci95(&r->t);
+            const char *verdict = "same";
+            if (now - now_ci > mean + ci && now > mean * (1.0 + tol)) { verdict = "SLOWER"; ++slower; }
+            else if (now + now_ci < mean - ci && now < mean * (1.0 - tol)) { verdict = "faster"; ++faster; }
+            printf("%-14s %7d %10zu %14.4e %14.4e %7.2fx  %s\n", r->kernel, r->workers, r->n, mean, now,
+                   mean / now, verdict);
+            ++matched;
+        }
+    }
+    free(buf);
+    printf("%d points compared: %d slower, %d faster, %d unchanged\n", matched, slower, faster,
+           matched - slower - faster);
+    return slower;
+}
+
+#endif // BENCH_H
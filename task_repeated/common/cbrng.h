@@ -0,0 +1,127 @@
+// cbrng.h
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., SC'11,
+// "Parallel random numbers: as easy as 1, 2, 3").
+//
+// There is no generator state to carry around: 128 random bits are a pure
+// function of (seed, stream, counter). Element i of a sequence can be made
+// on its own, so threads and ranks fill whatever index range they own and
+// the array has the same bits for any decomposition (no jump-ahead, no
+// hidden global state as with rand()). Use different streams for arrays
+// that must be independent (e.g. x = stream 0, y = stream 1).
+//
+//   cbrng_philox4x32   the raw bijection: 4x32-bit counter, 2x32-bit key
+//   cbrng_bits         (seed, stream, k) -> two 64-bit words
+//   cbrng_u01          64 random bits -> double in (0,1) (never 0 or 1)
+//   cbrng_uniform      element i of the uniform (0,1) sequence; elements
+//                      2k and 2k+1 are the two words of counter k
+//   cbrng_bits_batch   CBRNG_LANES consecutive counters at once (vectorizes)
+//   cbrng_fill_uniform out[j] = cbrng_uniform(seed, stream, first + j)
+// Normal variates on these streams: randn.h.
+//
+// Passes the Random123 known-answer tests; Philox4x32-10 passes BigCrush.
+
+#ifndef CBRNG_H
+#define CBRNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+#define CBRNG_M0 0xD2511F53u
+#define CBRNG_M1 0xCD9E8D57u
+#define CBRNG_W0 0x9E3779B9u   // golden ratio
+#define CBRNG_W1 0xBB67AE85u   // sqrt(3) - 1
+#define CBRNG_LANES 8          // counters per batch in the fill loops
+
+// batch loops are tagged for vectorization when built with -fopenmp
+#ifdef _OPENMP
+#define CBRNG_SIMD _Pragma("omp simd")
+#else
+#define CBRNG_SIMD
+#endif
+
+static inline void cbrng_philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < 10; ++r) {
+        uint64_t p0 = (uint64_t)CBRNG_M0 * c0;
+        uint64_t p1 = (uint64_t)CBRNG_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += CBRNG_W0;
+        k1 += CBRNG_W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// 128 bits for counter k of the given stream
+static inline void cbrng_bits(uint64_t seed, uint32_t stream, uint64_t k, uint64_t *w0, uint64_t *w1) {
+    uint32_t ctr[4] = { (uint32_t)k, (uint32_t)(k >> 32), stream, 0u };
+    uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+    uint32_t o[4];
+    cbrng_philox4x32(ctr, key, o);
+    *w0 = ((uint64_t)o[0] << 32) | o[1];
+    *w1 = ((uint64_t)o[2] << 32) | o[3];
+}
+
+// top 53 bits, centred in their interval: (m + 0.5) * 2^-53, m in [0, 2^53)
+static inline double cbrng_u01(uint64_t w) {
+    return ((double)(int64_t)(w >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static inline double cbrng_uniform(uint64_t seed, uint32_t stream, uint64_t i) {
+    uint64_t w0, w1;
+    cbrng_bits(seed, stream, i >> 1, &w0, &w1);
+    return cbrng_u01((i & 1) ? w1 : w0);
+}
+
+// Words of CBRNG_LANES consecutive counters k0, k0+1, ...: w[2l], w[2l+1]
+// for lane l. Same bits as cbrng_bits, but the lanes run side by side (the
+// 32x32->64 multiplies vectorize).
+static inline void cbrng_bits_batch(uint64_t seed, uint32_t stream, uint64_t k0, uint64_t w[2 * CBRNG_LANES]) {
+    const uint32_t key0 = (uint32_t)seed, key1 = (uint32_t)(seed >> 32);
+    CBRNG_SIMD
+    for (int l = 0; l < CBRNG_LANES; ++l) {
+        uint64_t k = k0 + (uint64_t)l;
+        uint32_t c0 = (uint32_t)k, c1 = (uint32_t)(k >> 32), c2 = stream, c3 = 0u;
+        uint32_t q0 = key0, q1 = key1;
+        for (int r = 0; r < 10; ++r) {
+            uint64_t p0 = (uint64_t)CBRNG_M0 * c0;
+            uint64_t p1 = (uint64_t)CBRNG_M1 * c2;
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ q0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ q1;
+            c1 = (uint32_t)p1;
+            c3 = (uint32_t)p0;
+            c0 = n0;
+            c2 = n2;
+            q0 += CBRNG_W0;
+            q1 += CBRNG_W1;
+        }
+        w[2 * l] = ((uint64_t)c0 << 32) | c1;
+        w[2 * l + 1] = ((uint64_t)c2 << 32) | c3;
+    }
+}
+
+static inline void cbrng_fill_uniform(uint64_t seed, uint32_t stream, uint64_t first, size_t n, double *out) {
+    size_t j = 0;
+    if (n && (first & 1)) out[j++] = cbrng_uniform(seed, stream, first);
+    for (; j + 2 * CBRNG_LANES <= n; j += 2 * CBRNG_LANES) {
+        uint64_t w[2 * CBRNG_LANES];
+        cbrng_bits_batch(seed, stream, (first + j) >> 1, w);
+        CBRNG_SIMD
+        for (int l = 0; l < 2 * CBRNG_LANES; ++l) out[j + l] = cbrng_u01(w[l]);
+    }
+    for (; j + 2 <= n; j += 2) {
+        uint64_t w0, w1;
+        cbrng_bits(seed, stream, (first + j) >> 1, &w0, &w1);
+        out[j] = cbrng_u01(w0);
+        out[j + 1] = cbrng_u01(w1);
+    }
+    if (j < n) out[j] = cbrng_uniform(seed, stream, first + j);
+}
+
+#endif // CBRNG_H
@@ -0,0 +1,336 @@
+// exactsum.h
+// Exact summation of doubles with a correctly rounded (round-to-nearest-
+// even) result, independent of the order of the additions.
+//
+// Every finite double is m * 2^(e-1075) with a 53-bit integer m, so any
+// sum of doubles is an integer multiple of 2^-1074. The "small"
+// superaccumulator stores that integer in 32-bit digits kept in int64 limbs
+// (the spare bits absorb carries, so a carry pass is only needed every 2^30
+// additions). Only the final conversion to double rounds.
+//
+// Fast path, per block of XSUM_BLOCK elements: if all exponents of the block
+// lie within 64 binades of a base position P, each element is an exact
+// 117-bit fixed-point number sm * 2^d (signed 54-bit mantissa, d in [0,63])
+// and is added as three digits (bits 0-31, 32-63 and the signed top word)
+// into three int64 sums, branch-free, so the loop vectorizes. P is taken
+// from the first element (52 binades below, 11 above) and, if that window
+// misses, once more from the block maximum. The three sums go into the small
+// accumulator at the end of the block.
+//
+// Other blocks (inf/nan, or exponents spread wider than 2^64) use the
+// "large" accumulator (after R. Neal, 2015): one integer add per element
+// into a bucket chosen by the 11-bit exponent field. Real data only hits a
+// handful of exponents, so the buckets stay in L1; a bucket is flushed into
+// the small accumulator every 512 additions (before its 63-bit magnitude can
+// overflow) and at the end. Flushing leaves the buckets zero, so xsum_exact
+// keeps one accumulator per thread and reuses it instead of allocating and
+// clearing 20 KB per call.
+//
+// Accumulators merge exactly, in any order: per-thread or per-rank partial
+// sums therefore give the same bits for any decomposition. For MPI, send
+// xsum_small.limb (XSUM_LIMBS int64, after xsum_small_carry) and merge.
+//
+// Inf/NaN inputs are summed separately with ordinary arithmetic and
+// override the exact result (inf + -inf gives NaN as usual).
+
+#ifndef EXACTSUM_H
+#define EXACTSUM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define XSUM_DIGIT_BITS 32
+#define XSUM_DIGIT_MASK 0xffffffffLL
+#define XSUM_LIMBS      68           // 2098 value bits + carry headroom
+#define XSUM_CARRY_EVERY (1LL << 30) // adds of < 2^32 before int64 can overflow
+#define XSUM_BUCKET_ADDS 512         // 53-bit mantissas per 63-bit bucket
+#define XSUM_BLOCK       1024        // fast-path block: 1024 top words of < 2^52
+
+// ---- small superaccumulator ----
+typedef struct {
+    int64_t limb[XSUM_LIMBS];  // value = sum limb[k] * 2^(32k - 1074)
+    int64_t adds_left;         // additions left before a carry pass
+    double special;            // sum of inf/nan inputs
+    int has_special;
+} xsum_small;
+
+static inline void xsum_small_init(xsum_small *a) {
+    memset(a, 0, sizeof(*a));
+    a->adds_left = XSUM_CARRY_EVERY;
+}
+
+// Carry pass: limbs 0..XSUM_LIMBS-2 end up in [0, 2^32), the sign of the
+// total sits in the top limb.
+static inline void xsum_small_carry(xsum_small *a) {
+    for (int k = 0; k < XSUM_LIMBS - 1; ++k) {
+        int64_t low = a->limb[k] & XSUM_DIGIT_MASK;
+        int64_t c = (a->limb[k] - low) / ((int64_t)1 << XSUM_DIGIT_BITS);  // exact
+        a->limb[k] = low;
+        a->limb[k + 1] += c;
+    }
+    a->adds_left = XSUM_CARRY_EVERY;
+}
+
+// Adds (neg ? -1 : 1) * m * 2^(pos - 1074), m < 2^63.
+static inline void xsum_small_add_mant(xsum_small *a, int pos, uint64_t m, int neg) {
+    int k = pos / XSUM_DIGIT_BITS, sh = pos % XSUM_DIGIT_BITS;
+    int64_t p0 = (int64_t)((m << sh) & XSUM_DIGIT_MASK);
+    int64_t p1 = (int64_t)((m >> (XSUM_DIGIT_BITS - sh)) & XSUM_DIGIT_MASK);
+    int64_t p2 = sh ? (int64_t)(m >> (64 - sh)) : 0;
+    if (neg) { p0 = -p0; p1 = -p1; p2 = -p2; }
+    a->limb[k] += p0;
+    a->limb[k + 1] += p1;
+    a->limb[k + 2] += p2;
+    if (--a->adds_left == 0) xsum_small_carry(a);
+}
+
+// Splits a finite double into (pos, m, neg); returns 0 for 0.0 and -1 for inf/nan.
+static inline int xsum_split(double x, int *pos, uint64_t *m, int *neg) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof bits);
+    int e = (int)((bits >> 52) & 0x7ff);
+    uint64_t mant = bits & ((1ULL << 52) - 1);
+    if (e == 0x7ff) return -1;
+    if (e == 0) {                 // zero or subnormal: m * 2^-1074
+        if (mant == 0) return 0;
+        *pos = 0;
+    } else {                      // normal: (2^52 + mant) * 2^(e-1075)
+        mant |= 1ULL << 52;
+        *pos = e - 1;
+    }
+    *m = mant;
+    *neg = (int)(bits >> 63);
+    return 1;
+}
+
+static inline void xsum_small_add(xsum_small *a, double x) {
+    int pos, neg;
+    uint64_t m;
+    int r = xsum_split(x, &pos, &m, &neg);
+    if (r > 0) xsum_small_add_mant(a, pos, m, neg);
+    else if (r < 0) { a->special += x; a->has_special = 1; }
+}
+
+// a += b (exact). b is left unchanged.
+static inline void xsum_small_merge(xsum_small *a, const xsum_small *b) {
+    xsum_small bb = *b;
+    xsum_small_carry(&bb);
+    xsum_small_carry(a);
+    for (int k = 0; k < XSUM_LIMBS; ++k) a->limb[k] += bb.limb[k];
+    xsum_small_carry(a);
+    if (b->has_special) { a->special += b->special; a->has_special = 1; }
+}
+
+// Correctly rounded value of the accumulator (round to nearest, ties to even).
+static inline double xsum_small_round(const xsum_small *acc) {
+    if (acc->has_special) return acc->special;
+    xsum_small a = *acc;
+    xsum_small_carry(&a);
+    int neg = a.limb[XSUM_LIMBS - 1] < 0;
+    if (neg) {
+        for (int k = 0; k < XSUM_LIMBS; ++k) a.limb[k] = -a.limb[k];
+        xsum_small_carry(&a);
+    }
+    int h = XSUM_LIMBS - 1;
+    while (h >= 0 && a.limb[h] == 0) --h;
+    if (h < 0) return 0.0;
+    if (a.limb[h] >= ((int64_t)1 << 62)) return neg ? -INFINITY : INFINITY;
+
+    // p = index of the highest set bit of the integer sum
+    int top = 63;
+    while (!((a.limb[h] >> top) & 1)) --top;
+    int p = h * XSUM_DIGIT_BITS + top;
+#define XSUM_BIT(i) ((uint64_t)((a.limb[(i) / XSUM_DIGIT_BITS] >> ((i) % XSUM_DIGIT_BITS)) & 1))
+
+    double r;
+    if (p <= 52) {                // fits a 53-bit integer: exact (maybe subnormal)
+        uint64_t M = 0;
+        for (int i = p; i >= 0; --i) M = (M << 1) | XSUM_BIT(i);
+        r = ldexp((double)M, -1074);
+    } else {
+        uint64_t M = 0;
+        for (int i = p; i >= p - 52; --i) M = (M << 1) | XSUM_BIT(i);
+        int round = (int)XSUM_BIT(p - 53);
+        int sticky = 0;
+        for (int i = p - 54; i >= 0 && !sticky; --i) {
+            if (i % XSUM_DIGIT_BITS == XSUM_DIGIT_BITS - 1 && a.limb[i / XSUM_DIGIT_BITS] == 0) {
+                i -= XSUM_DIGIT_BITS - 1;   // skip an all-zero digit
+                continue;
+            }
+            sticky = (int)XSUM_BIT(i);
+        }
+        if (round && (sticky || (M & 1))) {
+            ++M;
+            if (M == (1ULL << 53)) { M >>= 1; ++p; }
+        }
+        r = ldexp((double)M, p - 52 - 1074);   // overflows to inf if needed
+    }
+#undef XSUM_BIT
+    return neg ? -r : r;
+}
+
+// ---- large (bucketed) accumulator: the fast path ----
+typedef struct {
+    int64_t bucket[2048];      // signed sum of mantissas per exponent field
+    uint16_t count[2048];      // additions since the bucket was last flushed
+    int used;                  // some bucket may be nonzero
+    xsum_small small;
+} xsum_large;
+
+static inline void xsum_large_init(xsum_large *a) {
+    memset(a->bucket, 0, sizeof(a->bucket));
+    memset(a->count, 0, sizeof(a->count));
+    a->used = 0;
+    xsum_small_init(&a->small);
+}
+
+static inline void xsum_large_flush_bucket(xsum_large *a, int e) {
+    int64_t v = a->bucket[e];
+    if (v != 0) {
+        int pos = e ? e - 1 : 0;
+        if (v < 0) xsum_small_add_mant(&a->small, pos, (uint64_t)(-v), 1);
+        else       xsum_small_add_mant(&a->small, pos, (uint64_t)v, 0);
+    }
+    a->bucket[e] = 0;
+    a->count[e] = 0;
+}
+
+// Bit pattern loads the vectorizer accepts (memcpy per element blocks it)
+typedef uint64_t __attribute__((may_alias)) xsum_u64_alias;
+
+// Fixed-point sum of one block relative to base position P (see the top of
+// the file). Returns 0, adding nothing, if an element falls outside
+// [P, P+63] or is inf/nan. Relies on >> of negative int64 being arithmetic
+// (gcc, clang).
+static inline int xsum_block_fixed(xsum_small *s, const double *x, size_t n, int64_t P) {
+    const xsum_u64_alias *u = (const xsum_u64_alias*) x;
+    uint64_t a0 = 0, a1 = 0, bad = 0;
+    int64_t a2 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t b = u[i];
+        int64_t e = (int64_t)((b >> 52) & 0x7ff);
+        int64_t m = (int64_t)((b & ((1ULL << 52) - 1)) | ((uint64_t)(e != 0) << 52));
+        int64_t d = (e ? e - 1 : 0) - P;
+        bad |= ((uint64_t)d > 63 || e == 0x7ff) ? (uint64_t)m | (uint64_t)e : 0;  // zeros may sit anywhere
+        d &= 63;
+        int64_t sg = -(int64_t)(b >> 63);
+        int64_t sm = (m ^ sg) - sg;
+        uint64_t lo = (uint64_t)sm << d;
+        a0 += lo & XSUM_DIGIT_MASK;
+        a1 += lo >> XSUM_DIGIT_BITS;
+        a2 += (sm >> 1) >> (63 - d);   // sm * 2^d >> 64, arithmetic
+    }
+    if (bad) return 0;
+    if (a0) xsum_small_add_mant(s, (int)P, a0, 0);
+    if (a1) xsum_small_add_mant(s, (int)P + 32, a1, 0);
+    if (a2) xsum_small_add_mant(s, (int)P + 64, (uint64_t)(a2 < 0 ? -a2 : a2), a2 < 0);
+    return 1;
+}
+
+// Base position for a block: window [P, P+63] around the first element, or
+// ending at the block maximum (second try). Clamped to 0 (subnormals).
+static inline int64_t xsum_block_base(const double *x, size_t n, int from_max) {
+    const xsum_u64_alias *u = (const xsum_u64_alias*) x;
+    int64_t e = (int64_t)((u[0] >> 52) & 0x7ff);
+    if (from_max) {
+        e = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t ei = (int64_t)((u[i] >> 52) & 0x7ff);
+            e = (ei > e) ? ei : e;
+        }
+    }
+    int64_t P = (e ? e - 1 : 0) - (from_max ? 63 : 52);
+    return (P < 0) ? 0 : P;
+}
+
+static inline void xsum_large_add_buckets(xsum_large *a, const double *x, size_t n) {
+    a->used = 1;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t bits;
+        memcpy(&bits, &x[i], sizeof bits);
+        int e = (int)((bits >> 52) & 0x7ff);
+        if (e == 0x7ff) { a->small.special += x[i]; a->small.has_special = 1; continue; }
+        int64_t m = (int64_t)(bits & ((1ULL << 52) - 1)) | (e ? (int64_t)1 << 52 : 0);
+        a->bucket[e] += (bits >> 63) ? -m : m;
+        if (++a->count[e] == XSUM_BUCKET_ADDS) xsum_large_flush_bucket(a, e);
+    }
+}
+
+static inline void xsum_large_add_array(xsum_large *a, const double *x, size_t n) {
+    for (size_t b = 0; b < n; b += XSUM_BLOCK) {
+        size_t nb = (n - b < XSUM_BLOCK) ? n - b : XSUM_BLOCK;
+        if (!xsum_block_fixed(&a->small, x + b, nb, xsum_block_base(x + b, nb, 0)) &&
+            !xsum_block_fixed(&a->small, x + b, nb, xsum_block_base(x + b, nb, 1)))
+            xsum_large_add_buckets(a, x + b, nb);
+    }
+}
+
+// Flushes every bucket and returns the small accumulator holding the sum.
+// The buckets are zero afterwards: the accumulator takes a new sum once its
+// small part is reset (xsum_small_init).
+static inline xsum_small *xsum_large_small(xsum_large *a) {
+    if (!a->used) return &a->small;   // every block took the fast path
+    for (int e = 0; e < 2048; ++e)
+        if (a->count[e]) xsum_large_flush_bucket(a, e);
+    a->used = 0;
+    return &a->small;
+}
+
+// Empty accumulator of the calling thread, allocated on first use and kept
+// for the life of the thread. NULL if malloc fails.
+static inline xsum_large *xsum_large_thread(void) {
+    static _Thread_local xsum_large *cache = NULL;
+    if (!cache) {
+        cache = (xsum_large*) malloc(sizeof(xsum_large));
+        if (cache) xsum_large_init(cache);
+    } else {
+        xsum_small_init(&cache->small);
+    }
+    return cache;
+}
+
+// ---- convenience ----
+// Correctly rounded sum of x[0..n).
+static inline double xsum_exact(const double *x, size_t n) {
+    xsum_large *a = xsum_large_thread();
+    if (!a) return NAN;
+    xsum_large_add_array(a, x, n);
+    return xsum_small_round(xsum_large_small(a));
+}
+
+// Same with OpenMP threads: one large accumulator per thread, merged
+// exactly, so the bits do not depend on the thread count. A thread whose
+// accumulator could not be allocated still runs the worksharing loop (every
+// thread of the team must), skipping the work, and flags the failure.
+static inline double xsum_exact_omp(const double *x, size_t n) {
+#ifdef _OPENMP
+    xsum_small total;
+    xsum_small_init(&total);
+    int failed = 0;
+    #pragma omp parallel
+    {
+        xsum_large *a = xsum_large_thread();
+        #pragma omp for schedule(static)
+        for (size_t b = 0; b < n; b += 4096)
+            if (a) xsum_large_add_array(a, x + b, (n - b < 4096) ? n - b : 4096);
+        if (a) {
+            xsum_small *s = xsum_large_small(a);
+            #pragma omp critical
+            xsum_small_merge(&total, s);
+        } else {
+            #pragma omp atomic write
+            failed = 1;
+        }
+    }
+    return failed ? NAN : xsum_small_round(&total);
+#else
+    return xsum_exact(x, n);
+#endif
+}
+
+#endif // EXACTSUM_H
@@ -0,0 +1,134 @@
+// moments.h
+// Streaming mean / variance / skewness / kurtosis with mergeable states.
+//
+// The Welford update in task5/task5d.c divides once per element and runs
+// one element at a time. Here the data is taken in blocks of MOM_BLOCK
+// values (L1-resident): the block's mean and central power sums are two
+// vectorizable passes over the block, and the block state is folded into
+// the running state with the pairwise update of Chan et al. (1979),
+// extended to M3/M4 by Pébay (2008). The same mom_merge combines partial
+// states from threads or MPI ranks (a state is 5 doubles: gather them and
+// merge in rank order).
+//
+//   mom_push         one value (Welford/Terriberry update)
+//   mom_update       array, block by block
+//   mom_merge        a <- a (+) b
+//   mom_compute_omp  threaded; per-thread states merged in thread order
+//
+// Merging is exact in real arithmetic; in floating point the result
+// depends on the block/thread split only at rounding level.
+
+#ifndef MOMENTS_H
+#define MOMENTS_H
+
+#include <stddef.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MOM_BLOCK 1024
+
+// block loops are tagged for vectorization when built with -fopenmp
+#ifdef _OPENMP
+#define MOM_PRAGMA(x) _Pragma(#x)
+#define MOM_SIMD_SUM(...) MOM_PRAGMA(omp simd reduction(+:__VA_ARGS__))
+#else
+#define MOM_SIMD_SUM(...)
+#endif
+
+// n values, their mean and central sums M_k = sum (x - mean)^k
+typedef struct { double n, mean, M2, M3, M4; } mom_state;
+
+static inline void mom_init(mom_state *s) {
+    s->n = 0.0; s->mean = 0.0; s->M2 = 0.0; s->M3 = 0.0; s->M4 = 0.0;
+}
+
+static inline void mom_push(mom_state *s, double x) {
+    double n1 = s->n;
+    s->n += 1.0;
+    double delta = x - s->mean;
+    double dn = delta / s->n;
+    double dn2 = dn * dn;
+    double t = delta * dn * n1;
+    s->mean += dn;
+    s->M4 += t * dn2 * (s->n * s->n - 3.0 * s->n + 3.0) + 6.0 * dn2 * s->M2 - 4.0 * dn * s->M3;
+    s->M3 += t * dn * (s->n - 2.0) - 3.0 * dn * s->M2;
+    s->M2 += t;
+}
+
+static inline void mom_merge(mom_state *a, const mom_state *b) {
+    if (b->n == 0.0) return;
+    if (a->n == 0.0) { *a = *b; return; }
+    double na = a->n, nb = b->n, n = na + nb;
+    double d = b->mean - a->mean, d2 = d * d;
+    double M2 = a->M2 + b->M2 + d2 * na * nb / n;
+    double M3 = a->M3 + b->M3 + d2 * d * na * nb * (na - nb) / (n * n)
+              + 3.0 * d * (na * b->M2 - nb * a->M2) / n;
+    double M4 = a->M4 + b->M4 + d2 * d2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+              + 6.0 * d2 * (na * na * b->M2 + nb * nb * a->M2) / (n * n)
+              + 4.0 * d * (na * b->M3 - nb * a->M3) / n;
+    a->mean += d * nb / n;
+    a->n = n; a->M2 = M2; a->M3 = M3; a->M4 = M4;
+}
+
+// State of one block (n <= MOM_BLOCK, stays in cache): two passes.
+static inline mom_state mom_block(const double *x, size_t n) {
+    mom_state s;
+    double sum = 0.0;
+    MOM_SIMD_SUM(sum)
+    for (size_t i = 0; i < n; ++i) sum += x[i];
+    double m = sum / (double)n;
+    double s2 = 0.0, s3 = 0.0, s4 = 0.0;
+    MOM_SIMD_SUM(s2, s3, s4)
+    for (size_t i = 0; i < n; ++i) {
+        double d = x[i] - m, d2 = d * d;
+        s2 += d2; s3 += d2 * d; s4 += d2 * d2;
+    }
+    s.n = (double)n; s.mean = m; s.M2 = s2; s.M3 = s3; s.M4 = s4;
+    return s;
+}
+
+static inline void mom_update(mom_state *s, const double *x, size_t n) {
+    for (size_t i = 0; i < n; i += MOM_BLOCK) {
+        mom_state b = mom_block(x + i, (n - i < MOM_BLOCK) ? n - i : MOM_BLOCK);
+        mom_merge(s, &b);
+    }
+}
+
+static inline mom_state mom_compute_omp(const double *x, size_t n) {
+    mom_state total;
+    mom_init(&total);
+#ifdef _OPENMP
+    mom_state part[256];
+    int nt = 1;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), T = omp_get_num_threads();
+        if (T > 256) T = 256;
+        #pragma omp single
+        nt = T;
+        if (t < T) {
+            size_t lo = n * (size_t)t / (size_t)T, hi = n * (size_t)(t + 1) / (size_t)T;
+            mom_init(&part[t]);
+            mom_update(&part[t], x + lo, hi - lo);
+        }
+    }
+    for (int t = 0; t < nt; ++t) mom_merge(&total, &part[t]);
+#else
+    mom_update(&total, x, n);
+#endif
+    return total;
+}
+
+static inline double mom_mean(const mom_state *s) { return s->mean; }
+static inline double mom_var_sample(const mom_state *s) { return (s->n > 1.0) ? s->M2 / (s->n - 1.0) : NAN; }
+// population skewness g1 = m3 / m2^1.5 and excess kurtosis g2 = m4 / m2^2 - 3
+static inline double mom_skewness(const mom_state *s) {
+    return sqrt(s->n) * s->M3 / pow(s->M2, 1.5);
+}
+static inline double mom_kurtosis_excess(const mom_state *s) {
+    return s->n * s->M4 / (s->M2 * s->M2) - 3.0;
+}
+
+#endif // MOMENTS_H
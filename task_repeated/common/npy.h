@@ -0,0 +1,60 @@
+// npy.h
+// NumPy .npy files (format version 1.0) for 2D row-major arrays.
+//
+// A .npy file is a short text header (dtype with byte order, shape,
+// fortran_order) padded to a multiple of 64 bytes, followed by the raw
+// array. np.load(path, mmap_mode="r") maps the data in place, so a large
+// spectrum can be sliced without reading it all, and the shape and dtype
+// travel with the data instead of being hard-coded by the reader.
+//
+//   npy_write_header  header for rows x cols of "f8" (float64) or "c16"
+//                     (complex128 = interleaved re, im doubles, the layout
+//                     of fftw_complex); then fwrite the rows in order
+//   npy_read_header   parse it back: dtype, shape, data offset; fails on
+//                     other versions, Fortran order or foreign byte order
+
+#ifndef NPY_H
+#define NPY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static inline char npy_byte_order(void) {
+    const uint16_t one = 1;
+    return (*(const unsigned char*) &one == 1) ? '<' : '>';
+}
+
+static inline int npy_write_header(FILE *f, const char *dtype, size_t rows, size_t cols) {
+    char dict[128];
+    int len = snprintf(dict, sizeof dict, "{'descr': '%c%s', 'fortran_order': False, 'shape': (%zu, %zu), }",
+                       npy_byte_order(), dtype, rows, cols);
+    if (len < 0 || len >= (int)sizeof dict) return -1;
+    // magic (6) + version (2) + header length (2) + dict + spaces + '\n' = multiple of 64
+    size_t hlen = ((size_t)len + 1 + 10 + 63) / 64 * 64 - 10;
+    unsigned char pre[10] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                              (unsigned char)(hlen & 0xff), (unsigned char)(hlen >> 8) };
+    if (fwrite(pre, 1, sizeof pre, f) != sizeof pre || fwrite(dict, 1, (size_t)len, f) != (size_t)len) return -1;
+    for (size_t i = (size_t)len; i + 1 < hlen; ++i) fputc(' ', f);
+    return (fputc('\n', f) == '\n') ? 0 : -1;
+}
+
+// dtype gets e.g. "f8" / "c16"; returns the data offset, -1 if not a
+// readable 2D C-order array in host byte order
+static inline long npy_read_header(FILE *f, char dtype[8], size_t *rows, size_t *cols) {
+    unsigned char pre[10];
+    if (fread(pre, 1, sizeof pre, f) != sizeof pre || memcmp(pre, "\x93NUMPY", 6) != 0 || pre[6] != 1) return -1;
+    size_t hlen = (size_t)pre[8] | ((size_t)pre[9] << 8);
+    char *h = malloc(hlen + 1);
+    if (!h) return -1;
+    if (fread(h, 1, hlen, f) != hlen) { free(h); return -1; }
+    h[hlen] = '\0';
+    const char *d = strstr(h, "'descr': '"), *s = strstr(h, "'shape': (");
+    int ok = d && s && strstr(h, "'fortran_order': False") && d[10] == npy_byte_order();
+    if (ok) ok = sscanf(d + 11, "%7[a-z0-9]", dtype) == 1 && sscanf(s + 10, "%zu, %zu)", rows, cols) == 2;
+    free(h);
+    return ok ? (long)(10 + hlen) : -1;
+}
+
+#endif // NPY_H
@@ -0,0 +1,143 @@
+// perfctr.h
+// Optional hardware counters around a timed region, read with
+// perf_event_open(2): cycles, instructions, LLC misses and dTLB load misses,
+// user space only (exclude_kernel, so perf_event_paranoid <= 2 is enough: no
+// root, no perf tool). Build with -DUSE_PERFCTR on Linux (and define
+// _DEFAULT_SOURCE before the first system header, for syscall()); otherwise
+// every call is a no-op and perfctr_print prints nothing.
+//
+// The counters are opened once per process with inherit=1, so threads
+// created later are counted as well: call perfctr_init() before the first
+// OpenMP parallel region. Idle OpenMP workers spin-wait inside serial
+// regions too; OMP_WAIT_POLICY=passive keeps that out of the counts.
+// Events the CPU (or VM) does not expose are skipped, and if none opens the
+// regions are timed only.
+//
+//   perfctr_init();
+//   perfctr_region r;
+//   perfctr_begin(&r); ...hot loop...; perfctr_end(&r);
+//   printf("[TIME] ...");
+//   perfctr_print("add", &r, N, 24.0);   // N elements, 24 B/element nominal
+
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bench.h"
+
+#if defined(USE_PERFCTR) && defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PERFCTR_ON 1
+#else
+#define PERFCTR_ON 0
+#endif
+
+#define PERFCTR_LINE 64   // bytes per LLC miss
+
+enum { PC_CYCLES, PC_INSTR, PC_LLC_MISS, PC_DTLB_MISS, PC_NEV };
+
+typedef struct {
+    double   t0, seconds;
+    uint64_t v0[PC_NEV][3];   // value, time enabled, time running at begin
+    double   count[PC_NEV];   // scaled for multiplexing
+    int      have[PC_NEV];
+} perfctr_region;
+
+#if PERFCTR_ON
+static int  perfctr_fd[PC_NEV] = { -1, -1, -1, -1 };
+#endif
+static int  perfctr_state = 0;      // 0 not tried, 1 some counters open, -1 none
+static char perfctr_why[96] = "perfctr_init() not called";
+
+// Returns the number of counters that opened (0 = timing only).
+static inline int perfctr_init(void) {
+    if (perfctr_state != 0) return (perfctr_state > 0) ? 1 : 0;
+    perfctr_state = -1;
+#if PERFCTR_ON
+    static const struct { uint32_t type; uint64_t config; } ev[PC_NEV] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+    int opened = 0, err = 0;
+    for (int e = 0; e < PC_NEV; ++e) {
+        struct perf_event_attr a;
+        memset(&a, 0, sizeof a);
+        a.size = sizeof a;
+        a.type = ev[e].type;
+        a.config = ev[e].config;
+        a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        a.inherit = 1;
+        a.exclude_kernel = 1;
+        a.exclude_hv = 1;
+        perfctr_fd[e] = (int) syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+        if (perfctr_fd[e] >= 0) ++opened;
+        else if (!err) err = errno;
+    }
+    if (opened > 0) perfctr_state = 1;
+    else snprintf(perfctr_why, sizeof perfctr_why, "perf_event_open: %s", strerror(err));
+    return opened;
+#else
+    return 0;
+#endif
+}
+
+static inline void perfctr_begin(perfctr_region *r) {
+    memset(r, 0, sizeof *r);
+#if PERFCTR_ON
+    for (int e = 0; e < PC_NEV; ++e)
+        if (perfctr_fd[e] >= 0 && read(perfctr_fd[e], r->v0[e], sizeof r->v0[e]) != (ssize_t) sizeof r->v0[e])
+            r->v0[e][2] = UINT64_MAX;   // unreadable: skipped at the end
+#endif
+    r->t0 = bench_now();
+}
+
+static inline void perfctr_end(perfctr_region *r) {
+    r->seconds = bench_now() - r->t0;
+#if PERFCTR_ON
+    for (int e = 0; e < PC_NEV; ++e) {
+        uint64_t v1[3];
+        if (perfctr_fd[e] < 0 || r->v0[e][2] == UINT64_MAX ||
+            read(perfctr_fd[e], v1, sizeof v1) != (ssize_t) sizeof v1) continue;
+        uint64_t dv = v1[0] - r->v0[e][0], de = v1[1] - r->v0[e][1], dr = v1[2] - r->v0[e][2];
+        if (dr == 0) continue;          // never scheduled on the PMU
+        r->count[e] = (double)dv * ((double)de / (double)dr);
+        r->have[e] = 1;
+    }
+#endif
+}
+
+// One [PERF] line: IPC, LLC and dTLB misses per element and the DRAM bytes
+// per element they imply, next to the nominal bytes per element of the
+// kernel and the GB/s that nominal traffic gives over the measured time.
+static inline void perfctr_print(const char *label, const perfctr_region *r, double elems,
+                                 double bytes_per_elem) {
+    if (!PERFCTR_ON) return;
+    printf("[PERF] %s: %.1f B/elem nominal, %.2f GB/s", label, bytes_per_elem,
+           (r->seconds > 0.0) ? elems * bytes_per_elem / r->seconds * 1e-9 : 0.0);
+    if (perfctr_state <= 0) {
+        printf(" | counters unavailable (%s), timing only\n", perfctr_why);
+        return;
+    }
+    if (r->have[PC_CYCLES] && r->have[PC_INSTR] && r->count[PC_CYCLES] > 0.0)
+        printf(" | IPC %.2f (%.3g cycles, %.3g instr)", r->count[PC_INSTR] / r->count[PC_CYCLES],
+               r->count[PC_CYCLES], r->count[PC_INSTR]);
+    else if (r->have[PC_CYCLES])
+        printf(" | %.3g cycles", r->count[PC_CYCLES]);
+    if (r->have[PC_LLC_MISS])
+        printf(" | LLC miss %.3g/elem = %.1f B/elem from DRAM", r->count[PC_LLC_MISS] / elems,
+               PERFCTR_LINE * r->count[PC_LLC_MISS] / elems);
+    if (r->have[PC_DTLB_MISS])
+        printf(" | dTLB miss %.3g/elem", r->count[PC_DTLB_MISS] / elems);
+    printf("\n");
+}
+
+#endif // PERFCTR_H
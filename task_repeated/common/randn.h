@@ -0,0 +1,150 @@
+// randn.h
+// Batch N(mean, std^2) generators on top of the Philox streams of cbrng.h.
+//
+//   RANDN_BOXMULLER  counter k -> two uniforms -> the pair (2k, 2k+1):
+//                    z0 = r cos(2 pi u2), z1 = r sin(2 pi u2), r = sqrt(-2 log u1).
+//                    Both variates are kept; log/sincos come from vmath.h, so
+//                    CBRNG_LANES pairs are computed per vector pass.
+//   RANDN_ZIGGURAT   Marsaglia–Tsang ziggurat, 128 layers, in Doornik's
+//                    (2005) double-precision form: ~99% of the draws cost one
+//                    multiply and a compare, no transcendental at all.
+//                    Attempt j of element i uses counter i of stream
+//                    stream ^ (j << 16), so element i still depends only on
+//                    (seed, stream, i); keep stream ids below 2^16.
+//
+// Both fill out[j] with element first + j of the sequence: any split of the
+// index range over threads or ranks gives the same array.
+//
+// Build with -fno-math-errno: otherwise gcc keeps a branch to the libm sqrt
+// (for errno) and the Box–Muller loop does not vectorize. Unlike
+// -ffast-math it does not change any rounding.
+
+#ifndef RANDN_H
+#define RANDN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "cbrng.h"
+#include "vmath.h"
+
+typedef enum { RANDN_BOXMULLER = 0, RANDN_ZIGGURAT = 1 } randn_method;
+
+// ---- Box–Muller ----
+static inline void randn_bm_pair(uint64_t w0, uint64_t w1, double *z0, double *z1) {
+    double r = sqrt(-2.0 * vm_log(cbrng_u01(w0)));
+    double s, c;
+    vm_sincos(6.283185307179586477 * cbrng_u01(w1), &s, &c);
+    *z0 = r * c;
+    *z1 = r * s;
+}
+
+static inline void randn_fill_bm(uint64_t seed, uint32_t stream, uint64_t first, size_t n,
+                                 double mean, double std, double *out) {
+    size_t j = 0;
+    uint64_t w0, w1;
+    double z0, z1;
+    if (n && (first & 1)) {
+        cbrng_bits(seed, stream, first >> 1, &w0, &w1);
+        randn_bm_pair(w0, w1, &z0, &z1);
+        out[j++] = mean + std * z1;
+    }
+    for (; j + 2 * CBRNG_LANES <= n; j += 2 * CBRNG_LANES) {
+        uint64_t w[2 * CBRNG_LANES];
+        cbrng_bits_batch(seed, stream, (first + j) >> 1, w);
+        double *o = out + j;
+        CBRNG_SIMD
+        for (int l = 0; l < CBRNG_LANES; ++l) {
+            double a, b;
+            randn_bm_pair(w[2 * l], w[2 * l + 1], &a, &b);
+            o[2 * l] = mean + std * a;
+            o[2 * l + 1] = mean + std * b;
+        }
+    }
+    for (; j < n; j += 2) {
+        cbrng_bits(seed, stream, (first + j) >> 1, &w0, &w1);
+        randn_bm_pair(w0, w1, &z0, &z1);
+        out[j] = mean + std * z0;
+        if (j + 1 < n) out[j + 1] = mean + std * z1;
+    }
+}
+
+// ---- Ziggurat ----
+#define RANDN_ZIG_C 128
+#define RANDN_ZIG_R 3.442619855899            // start of the tail
+#define RANDN_ZIG_V 9.91256303526217e-3       // area of each layer
+
+typedef struct {
+    double x[RANDN_ZIG_C + 1];   // layer edges, x[1] = R, x[C] = 0
+    double r[RANDN_ZIG_C];       // x[i+1] / x[i]: inner (always accepted) part
+} randn_zig;
+
+static inline void randn_zig_init(randn_zig *z) {
+    double f = exp(-0.5 * RANDN_ZIG_R * RANDN_ZIG_R);
+    z->x[0] = RANDN_ZIG_V / f;
+    z->x[1] = RANDN_ZIG_R;
+    z->x[RANDN_ZIG_C] = 0.0;
+    for (int i = 2; i < RANDN_ZIG_C; ++i) {
+        z->x[i] = sqrt(-2.0 * log(RANDN_ZIG_V / z->x[i - 1] + f));
+        f = exp(-0.5 * z->x[i] * z->x[i]);
+    }
+    for (int i = 0; i < RANDN_ZIG_C; ++i) z->r[i] = z->x[i + 1] / z->x[i];
+}
+
+// One N(0,1) variate for element i.
+static inline double randn_zig_one(const randn_zig *z, uint64_t seed, uint32_t stream, uint64_t i) {
+    for (uint32_t j = 0;; ++j) {
+        uint64_t w0, w1;
+        cbrng_bits(seed, stream ^ (j << 16), i, &w0, &w1);
+        double u = 2.0 * cbrng_u01(w0) - 1.0;
+        int l = (int)(w1 & (RANDN_ZIG_C - 1));
+        if (fabs(u) < z->r[l]) return u * z->x[l];
+        if (l == 0) {
+            // tail beyond R (Marsaglia 1964), fresh uniforms from later attempts
+            double x, y;
+            do {
+                cbrng_bits(seed, stream ^ (++j << 16), i, &w0, &w1);
+                x = log(cbrng_u01(w0)) / RANDN_ZIG_R;
+                y = log(cbrng_u01(w1));
+            } while (-2.0 * y < x * x);
+            return (u < 0.0) ? x - RANDN_ZIG_R : RANDN_ZIG_R - x;
+        }
+        double x = u * z->x[l];
+        double f0 = exp(-0.5 * (z->x[l] * z->x[l] - x * x));
+        double f1 = exp(-0.5 * (z->x[l + 1] * z->x[l + 1] - x * x));
+        if (f1 + cbrng_u01(w1) * (f0 - f1) < 1.0) return x;
+    }
+}
+
+// First attempts come CBRNG_LANES at a time from the batched Philox; the
+// rare misses redo the element with randn_zig_one (same attempt-0 bits).
+static inline void randn_fill_zig(const randn_zig *z, uint64_t seed, uint32_t stream, uint64_t first,
+                                  size_t n, double mean, double std, double *out) {
+    size_t nfull = n - n % CBRNG_LANES;
+    for (size_t j = 0; j < nfull; j += CBRNG_LANES) {
+        uint64_t w[2 * CBRNG_LANES];
+        cbrng_bits_batch(seed, stream, first + j, w);
+        for (int l = 0; l < CBRNG_LANES; ++l) {
+            double u = 2.0 * cbrng_u01(w[2 * l]) - 1.0;
+            int k = (int)(w[2 * l + 1] & (RANDN_ZIG_C - 1));
+            double v = (fabs(u) < z->r[k]) ? u * z->x[k] : randn_zig_one(z, seed, stream, first + j + (size_t)l);
+            out[j + (size_t)l] = mean + std * v;
+        }
+    }
+    for (size_t j = nfull; j < n; ++j) out[j] = mean + std * randn_zig_one(z, seed, stream, first + j);
+}
+
+// ---- one entry point ----
+static inline void randn_fill(randn_method m, uint64_t seed, uint32_t stream, uint64_t first,
+                              size_t n, double mean, double std, double *out) {
+    if (m == RANDN_ZIGGURAT) {
+        randn_zig z;
+        randn_zig_init(&z);
+        randn_fill_zig(&z, seed, stream, first, n, mean, std, out);
+    } else {
+        randn_fill_bm(seed, stream, first, n, mean, std, out);
+    }
+}
+
+#endif // RANDN_H
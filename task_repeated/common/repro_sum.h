@@ -0,0 +1,107 @@
+// repro_sum.h
+// Reproducible sum: same bits for any number of threads or MPI ranks.
+//
+// The index range [0,n) is cut into fixed blocks of REPRO_BLOCK elements.
+// Each block is summed in a fixed order, and the block sums are combined
+// with a pairwise tree whose shape only depends on the number of blocks.
+// Whoever computes a block (thread, rank) does not change its value, so
+// the final result only depends on n and the data.
+//
+// Rule for parallel callers: every worker must own whole blocks, i.e. its
+// first index must be a multiple of REPRO_BLOCK.
+//
+// Note: do not build with -ffast-math if the bits have to match between
+// different binaries (e.g. task9_openmp vs task9_mpi); inside one binary
+// the result is reproducible either way.
+
+#ifndef REPRO_SUM_H
+#define REPRO_SUM_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef REPRO_BLOCK
+#define REPRO_BLOCK 1024   // elements per block (8 KiB, fits in L1)
+#endif
+
+static inline size_t repro_nblocks(size_t n) {
+    return (n + REPRO_BLOCK - 1) / REPRO_BLOCK;
+}
+
+// Fixed-order sum of one block (n <= REPRO_BLOCK).
+// Four interleaved accumulators keep the adds pipelined; they are always
+// combined as (s0+s1)+(s2+s3).
+static inline double repro_block_sum(const double *a, size_t n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i];
+        s1 += a[i + 1];
+        s2 += a[i + 2];
+        s3 += a[i + 3];
+    }
+    for (; i < n; ++i) s0 += a[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Block sums of a[0..n): bs[b] = sum of block b. a must start on a block
+// boundary of the global array. Returns the number of blocks written.
+static inline size_t repro_block_sums(const double *a, size_t n, double *bs) {
+    size_t nb = repro_nblocks(n);
+    for (size_t b = 0; b < nb; ++b) {
+        size_t start = b * REPRO_BLOCK;
+        size_t len = (n - start < REPRO_BLOCK) ? n - start : REPRO_BLOCK;
+        bs[b] = repro_block_sum(a + start, len);
+    }
+    return nb;
+}
+
+// Pairwise tree over the block sums. The split point is nb/2 at every
+// level, so the shape is fixed by nb alone.
+static inline double repro_tree(const double *bs, size_t nb) {
+    if (nb == 0) return 0.0;
+    if (nb == 1) return bs[0];
+    if (nb == 2) return bs[0] + bs[1];
+    size_t h = nb / 2;
+    return repro_tree(bs, h) + repro_tree(bs + h, nb - h);
+}
+
+// Reproducible sum of a[0..n). With -fopenmp the block sums are computed
+// by all threads (static schedule over blocks); without it, serially.
+// Both give identical bits. Returns NAN if the block-sum buffer
+// (n/REPRO_BLOCK doubles) cannot be allocated.
+static inline double repro_sum(const double *a, size_t n) {
+    size_t nb = repro_nblocks(n);
+    if (nb == 0) return 0.0;
+    double *bs = (double*) malloc(nb * sizeof(double));
+    if (!bs) return NAN;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t b = 0; b < nb; ++b) {
+        size_t start = b * REPRO_BLOCK;
+        size_t len = (n - start < REPRO_BLOCK) ? n - start : REPRO_BLOCK;
+        bs[b] = repro_block_sum(a + start, len);
+    }
+    double s = repro_tree(bs, nb);
+    free(bs);
+    return s;
+}
+
+// Split nblocks whole blocks over `size` workers (base/rem like the
+// scatter in task9_mpi.c) and return element counts/offsets for worker r.
+static inline void repro_partition(size_t n, int size, int r,
+                                   size_t *first, size_t *count) {
+    size_t nb = repro_nblocks(n);
+    size_t base = nb / (size_t)size, rem = nb % (size_t)size;
+    size_t b0 = (size_t)r * base + ((size_t)r < rem ? (size_t)r : rem);
+    size_t b1 = b0 + base + ((size_t)r < rem ? 1 : 0);
+    size_t e0 = b0 * REPRO_BLOCK, e1 = b1 * REPRO_BLOCK;
+    if (e0 > n) e0 = n;
+    if (e1 > n) e1 = n;
+    *first = e0;
+    *count = e1 - e0;
+}
+
+#endif // REPRO_SUM_H
@@ -0,0 +1,157 @@
+// sumlib.h
+// Compensated and pairwise summation kernels that keep up with memory.
+//
+// kahan_sum in task5/task5c.c is accurate but every step waits for the
+// previous one (add latency ~4 cycles per element). The kernels here run
+// SUM_LANES independent accumulators side by side; the lanes vectorize and
+// hide the latency, and are merged with a compensated combine at the end.
+//
+//   sum_kahan_simd     Kahan, SUM_LANES lanes
+//   sum_neumaier_simd  Neumaier (Kahan–Babuska), SUM_LANES lanes; also
+//                      correct when an addend is larger than the running sum
+//   sum_pairwise       recursive halving, SUM_LANES-wide plain sum at the
+//                      leaves; error O(eps log n) at naive-sum speed
+//   sum_neumaier_omp   threaded Neumaier: each thread sums its static chunk,
+//                      per-thread (s, c) pairs are combined in thread order
+//
+// All kernels need IEEE semantics: do not build with -ffast-math (it lets
+// the compiler cancel the compensation terms).
+
+#ifndef SUMLIB_H
+#define SUMLIB_H
+
+#include <stddef.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef SUM_LANES
+#define SUM_LANES 8   // 2 AVX-512 or 4 AVX2 registers of doubles
+#endif
+
+#define SUM_PAIRWISE_LEAF 256
+
+// lane loops are tagged for vectorization when built with -fopenmp
+#ifdef _OPENMP
+#define SUM_SIMD _Pragma("omp simd")
+#else
+#define SUM_SIMD
+#endif
+
+// Running compensated sum: value = s + c.
+typedef struct { double s, c; } sum_acc;
+
+// Neumaier step: add x to (s, c).
+static inline void sum_acc_add(sum_acc *a, double x) {
+    double t = a->s + x;
+    a->c += (fabs(a->s) >= fabs(x)) ? (a->s - t) + x : (x - t) + a->s;
+    a->s = t;
+}
+
+// Merge b into a (both terms of b are added with compensation).
+static inline void sum_acc_merge(sum_acc *a, sum_acc b) {
+    sum_acc_add(a, b.s);
+    sum_acc_add(a, b.c);
+}
+
+// Neumaier over SUM_LANES interleaved lanes; returns the unreduced (s, c).
+static inline sum_acc sum_neumaier_acc(const double *a, size_t n) {
+    double s[SUM_LANES] = {0.0}, c[SUM_LANES] = {0.0};
+    size_t i = 0;
+    for (; i + SUM_LANES <= n; i += SUM_LANES) {
+        SUM_SIMD
+        for (int l = 0; l < SUM_LANES; ++l) {
+            double x = a[i + l];
+            double t = s[l] + x;
+            double big = (fabs(s[l]) >= fabs(x)) ? s[l] : x;
+            double small = (fabs(s[l]) >= fabs(x)) ? x : s[l];
+            c[l] += (big - t) + small;
+            s[l] = t;
+        }
+    }
+    sum_acc acc = { 0.0, 0.0 };
+    for (; i < n; ++i) sum_acc_add(&acc, a[i]);
+    for (int l = 0; l < SUM_LANES; ++l) {
+        sum_acc_add(&acc, s[l]);
+        acc.c += c[l];
+    }
+    return acc;
+}
+
+static inline double sum_neumaier_simd(const double *a, size_t n) {
+    sum_acc acc = sum_neumaier_acc(a, n);
+    return acc.s + acc.c;
+}
+
+// Kahan over SUM_LANES lanes (cheaper than Neumaier, assumes the running
+// sum dominates the addends, as in the original kahan_sum).
+static inline double sum_kahan_simd(const double *a, size_t n) {
+    double s[SUM_LANES] = {0.0}, c[SUM_LANES] = {0.0};
+    size_t i = 0;
+    for (; i + SUM_LANES <= n; i += SUM_LANES) {
+        SUM_SIMD
+        for (int l = 0; l < SUM_LANES; ++l) {
+            double y = a[i + l] - c[l];
+            double t = s[l] + y;
+            c[l] = (t - s[l]) - y;
+            s[l] = t;
+        }
+    }
+    sum_acc acc = { 0.0, 0.0 };
+    for (; i < n; ++i) sum_acc_add(&acc, a[i]);
+    for (int l = 0; l < SUM_LANES; ++l) {
+        sum_acc_add(&acc, s[l]);
+        sum_acc_add(&acc, -c[l]);
+    }
+    return acc.s + acc.c;
+}
+
+// Plain SUM_LANES-wide sum used at the pairwise leaves.
+static inline double sum_lanes(const double *a, size_t n) {
+    double s[SUM_LANES] = {0.0};
+    size_t i = 0;
+    for (; i + SUM_LANES <= n; i += SUM_LANES) {
+        SUM_SIMD
+        for (int l = 0; l < SUM_LANES; ++l) s[l] += a[i + l];
+    }
+    double r = 0.0;
+    for (; i < n; ++i) r += a[i];
+    for (int l = 0; l < SUM_LANES; ++l) r += s[l];
+    return r;
+}
+
+static inline double sum_pairwise(const double *a, size_t n) {
+    if (n <= SUM_PAIRWISE_LEAF) return sum_lanes(a, n);
+    size_t h = n / 2;
+    return sum_pairwise(a, h) + sum_pairwise(a + h, n - h);
+}
+
+// Threaded Neumaier. Without -fopenmp this is sum_neumaier_simd.
+// Per-thread partials are merged in thread order, so the result depends on
+// the thread count only through the chunk boundaries (for bit-identical
+// sums across thread counts use ../common/repro_sum.h).
+static inline double sum_neumaier_omp(const double *a, size_t n) {
+#ifdef _OPENMP
+    sum_acc part[256];
+    int nt = 1;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), T = omp_get_num_threads();
+        if (T > 256) T = 256;
+        #pragma omp single
+        nt = T;
+        if (t < T) {
+            size_t lo = n * (size_t)t / (size_t)T, hi = n * (size_t)(t + 1) / (size_t)T;
+            part[t] = sum_neumaier_acc(a + lo, hi - lo);
+        }
+    }
+    sum_acc acc = { 0.0, 0.0 };
+    for (int t = 0; t < nt; ++t) sum_acc_merge(&acc, part[t]);
+    return acc.s + acc.c;
+#else
+    return sum_neumaier_simd(a, n);
+#endif
+}
+
+#endif // SUMLIB_H
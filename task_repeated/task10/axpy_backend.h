@@ -0,0 +1,40 @@
+// axpy_backend.h
+// Backend interface for the task10 axpy harness: d = a*x + y.
+// Every backend goes through the same three steps so the harness can time
+// them the same way:
+//   upload   : make x,y visible to the backend (H2D copy for CUDA,
+//              first-touch copy into backend-owned buffers for CPU)
+//   kernel   : compute d, returns kernel-only time in ms, measured by the
+//              backend (CUDA events on the GPU, steady_clock on the CPU)
+//   download : copy d back into a host array (D2H for CUDA)
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class AxpyBackend {
+public:
+  virtual ~AxpyBackend() = default;
+  virtual const char* name() const = 0;
+  virtual void upload(const double* x, const double* y, size_t n) = 0;
+  virtual double kernel(double a) = 0;  // ms, kernel only
+  virtual void download(double* d) = 0;
+};
+
+// CPU backends (axpy_cpu.cpp)
+std::unique_ptr<AxpyBackend> make_serial_backend();
+std::unique_ptr<AxpyBackend> make_openmp_backend();
+std::unique_ptr<AxpyBackend> make_simd_backend();
+
+#ifdef HAVE_CUDA
+// GPU backend (axpy_cuda.cu), only built when nvcc is found
+std::unique_ptr<AxpyBackend> make_cuda_backend();
+#endif
+
+// Looks a backend up by name ("serial", "openmp", "simd", "cuda").
+// Returns nullptr if the name is unknown or not compiled in.
+std::unique_ptr<AxpyBackend> make_backend(const char* name);
+
+// Names of all backends compiled into this binary, in report order.
+std::vector<const char*> backend_names();
@@ -0,0 +1,162 @@
+// axpy_cpu.cpp — CPU backends for the task10 axpy harness.
+// All three keep their own x, y, d buffers (64-byte aligned) so that upload
+// and download cost the same kind of copy as H2D/D2H on the GPU.
+
+#include "axpy_backend.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+double* alloc_aligned(size_t n) {
+  size_t bytes = ((n * sizeof(double) + 63) / 64) * 64;
+  void* p = std::aligned_alloc(64, bytes ? bytes : 64);
+  if (!p) {
+    fprintf(stderr, "Allocation failed (%zu bytes)\n", bytes);
+    std::exit(1);
+  }
+  return static_cast<double*>(p);
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point t0,
+                  std::chrono::steady_clock::time_point t1) {
+  return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// Shared buffer handling; subclasses only provide the compute loop.
+class CpuBackend : public AxpyBackend {
+public:
+  ~CpuBackend() override { std::free(x_); std::free(y_); std::free(d_); }
+
+  void upload(const double* x, const double* y, size_t n) override {
+    if (n != n_) {
+      std::free(x_); std::free(y_); std::free(d_);
+      x_ = alloc_aligned(n); y_ = alloc_aligned(n); d_ = alloc_aligned(n);
+      n_ = n;
+    }
+    copy_in(x, y);
+  }
+
+  double kernel(double a) override {
+    auto t0 = std::chrono::steady_clock::now();
+    compute(a);
+    auto t1 = std::chrono::steady_clock::now();
+    return elapsed_ms(t0, t1);
+  }
+
+  void download(double* d) override { std::memcpy(d, d_, n_ * sizeof(double)); }
+
+protected:
+  virtual void copy_in(const double* x, const double* y) {
+    std::memcpy(x_, x, n_ * sizeof(double));
+    std::memcpy(y_, y, n_ * sizeof(double));
+  }
+  virtual void compute(double a) = 0;
+
+  double* x_ = nullptr;
+  double* y_ = nullptr;
+  double* d_ = nullptr;
+  size_t n_ = 0;
+};
+
+// ---- serial: the CPU baseline loop, one thread ----
+class SerialBackend : public CpuBackend {
+public:
+  const char* name() const override { return "serial"; }
+protected:
+  void compute(double a) override {
+    const double* __restrict__ x = x_;
+    const double* __restrict__ y = y_;
+    double* __restrict__ d = d_;
+    for (size_t i = 0; i < n_; ++i) d[i] = a * x[i] + y[i];
+  }
+};
+
+// ---- openmp: static schedule, inputs first-touched with the same schedule ----
+class OpenmpBackend : public CpuBackend {
+public:
+  const char* name() const override { return "openmp"; }
+protected:
+  void copy_in(const double* x, const double* y) override {
+    double* __restrict__ xo = x_;
+    double* __restrict__ yo = y_;
+    double* __restrict__ d = d_;
+    const long long n = (long long)n_;
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i) { xo[i] = x[i]; yo[i] = y[i]; d[i] = 0.0; }
+  }
+  void compute(double a) override {
+    const double* __restrict__ x = x_;
+    const double* __restrict__ y = y_;
+    double* __restrict__ d = d_;
+    const long long n = (long long)n_;
+    #pragma omp parallel for simd schedule(static)
+    for (long long i = 0; i < n; ++i) d[i] = a * x[i] + y[i];
+  }
+};
+
+// ---- simd: explicit vector loop on one thread ----
+// Uses mul + add (no FMA) so the result is bit-identical to the baseline.
+class SimdBackend : public CpuBackend {
+public:
+  const char* name() const override { return "simd"; }
+protected:
+  void compute(double a) override {
+    const double* __restrict__ x = x_;
+    const double* __restrict__ y = y_;
+    double* __restrict__ d = d_;
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d va = _mm512_set1_pd(a);
+    for (; i + 8 <= n_; i += 8) {
+      __m512d v = _mm512_add_pd(_mm512_mul_pd(va, _mm512_load_pd(x + i)), _mm512_load_pd(y + i));
+      _mm512_store_pd(d + i, v);
+    }
+#elif defined(__AVX__)
+    const __m256d va = _mm256_set1_pd(a);
+    for (; i + 4 <= n_; i += 4) {
+      __m256d v = _mm256_add_pd(_mm256_mul_pd(va, _mm256_load_pd(x + i)), _mm256_load_pd(y + i));
+      _mm256_store_pd(d + i, v);
+    }
+#else
+    #pragma omp simd
+    for (size_t j = 0; j < n_; ++j) d[j] = a * x[j] + y[j];
+    i = n_;
+#endif
+    for (; i < n_; ++i) d[i] = a * x[i] + y[i];
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<AxpyBackend> make_serial_backend() { return std::make_unique<SerialBackend>(); }
+std::unique_ptr<AxpyBackend> make_openmp_backend() { return std::make_unique<OpenmpBackend>(); }
+std::unique_ptr<AxpyBackend> make_simd_backend()   { return std::make_unique<SimdBackend>(); }
+
+std::unique_ptr<AxpyBackend> make_backend(const char* name) {
+  if (std::strcmp(name, "serial") == 0) return make_serial_backend();
+  if (std::strcmp(name, "openmp") == 0) return make_openmp_backend();
+  if (std::strcmp(name, "simd") == 0)   return make_simd_backend();
+#ifdef HAVE_CUDA
+  if (std::strcmp(name, "cuda") == 0)   return make_cuda_backend();
+#endif
+  return nullptr;
+}
+
+std::vector<const char*> backend_names() {
+  std::vector<const char*> names = {"serial", "openmp", "simd"};
+#ifdef HAVE_CUDA
+  names.push_back("cuda");
+#endif
+  return names;
+}
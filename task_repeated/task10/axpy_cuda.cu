@@ -0,0 +1,79 @@
+// axpy_cuda.cu — CUDA backend for the task10 axpy harness.
+// Built only when nvcc is available (see Makefile, defines HAVE_CUDA).
+
+#include "axpy_backend.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef CHECK_CUDA
+#define CHECK_CUDA(call) do { \
+  cudaError_t _e = (call); \
+  if (_e != cudaSuccess) { \
+    fprintf(stderr, "CUDA error %s:%d: %s\n", __FILE__, __LINE__, cudaGetErrorString(_e)); \
+    std::exit(1); \
+  } \
+} while(0)
+#endif
+
+__global__ void axpy_kernel(const double a, const double* __restrict__ x,
+                            const double* __restrict__ y, double* __restrict__ d,
+                            size_t n) {
+  size_t i = blockIdx.x * (size_t)blockDim.x + threadIdx.x;
+  if (i < n) d[i] = a * x[i] + y[i];
+}
+
+namespace {
+
+class CudaBackend : public AxpyBackend {
+public:
+  CudaBackend() {
+    CHECK_CUDA(cudaEventCreate(&e0_));
+    CHECK_CUDA(cudaEventCreate(&e1_));
+  }
+  ~CudaBackend() override {
+    cudaEventDestroy(e0_); cudaEventDestroy(e1_);
+    cudaFree(dd_); cudaFree(dy_); cudaFree(dx_);
+  }
+
+  const char* name() const override { return "cuda"; }
+
+  void upload(const double* x, const double* y, size_t n) override {
+    if (n != n_) {
+      cudaFree(dd_); cudaFree(dy_); cudaFree(dx_);
+      CHECK_CUDA(cudaMalloc((void**)&dx_, n*sizeof(double)));
+      CHECK_CUDA(cudaMalloc((void**)&dy_, n*sizeof(double)));
+      CHECK_CUDA(cudaMalloc((void**)&dd_, n*sizeof(double)));
+      n_ = n;
+    }
+    CHECK_CUDA(cudaMemcpy(dx_, x, n*sizeof(double), cudaMemcpyHostToDevice));
+    CHECK_CUDA(cudaMemcpy(dy_, y, n*sizeof(double), cudaMemcpyHostToDevice));
+  }
+
+  // Use CUDA events for accurate GPU timing
+  double kernel(double a) override {
+    int block = 256;
+    int grid  = (int)((n_ + block - 1) / block);
+    CHECK_CUDA(cudaEventRecord(e0_));
+    axpy_kernel<<<grid, block>>>(a, dx_, dy_, dd_, n_);
+    CHECK_CUDA(cudaEventRecord(e1_));
+    CHECK_CUDA(cudaEventSynchronize(e1_));
+    CHECK_CUDA(cudaGetLastError());
+    float ms = 0.0f;
+    CHECK_CUDA(cudaEventElapsedTime(&ms, e0_, e1_));
+    return (double)ms;
+  }
+
+  void download(double* d) override {
+    CHECK_CUDA(cudaMemcpy(d, dd_, n_*sizeof(double), cudaMemcpyDeviceToHost));
+  }
+
+private:
+  double *dx_ = nullptr, *dy_ = nullptr, *dd_ = nullptr;
+  size_t n_ = 0;
+  cudaEvent_t e0_, e1_;
+};
+
+}  // namespace
+
+std::unique_ptr<AxpyBackend> make_cuda_backend() { return std::make_unique<CudaBackend>(); }
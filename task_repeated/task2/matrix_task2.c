@@ -1,12 +1,18 @@
 // matrix_task02.c
 // C = A * B with A=3.0, B=7.1 for N in {10, 100, 10000}.
 // Uses naive multiplication when N<=1000; analytic check for larger N.
+// Build: gcc -O3 -march=native -std=c11 matrix_task2.c -o matrix_task2 -lm
+//   add -DUSE_PERFCTR for a [PERF] line (IPC, LLC / dTLB misses) after the
+//   GEMM [TIME] line, see ../common/perfctr.h
 
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <stdbool.h>
 
+#include "../common/perfctr.h"
+
 static inline bool isclose(double a, double b, double atol) {
     return fabs(a - b) <= atol;
 }
@@ -37,6 +43,8 @@ void multiply_naive(long long N, double aval, double bval) {
     for (long long i = 0; i < N*N; ++i) B[i] = bval;
 
     // C = A * B (triple loop)
+    perfctr_region pc;
+    perfctr_begin(&pc);
     for (long long i = 0; i < N; ++i) {
         for (long long j = 0; j < N; ++j) {
             double s = 0.0;
@@ -46,6 +54,7 @@ void multiply_naive(long long N, double aval, double bval) {
             set(C,N,i,j,s);
         }
     }
+    perfctr_end(&pc);
 
     // Verify: each entry should equal (3.0*7.1)*N = 21.3*N
     double expected = 21.3 * (double)N;
@@ -70,6 +79,12 @@ void multiply_naive(long long N, double aval, double bval) {
     for (long long i = 0; i < N*N; ++i) sum += C[i];
     printf("  checksum(sum of all C) = %.0Lf\n", sum);
 
+    // per inner iteration: one multiply-add, loads A[i,k] and B[k,j] (8 B each)
+    double madds = (double)N * (double)N * (double)N;
+    printf("[TIME] naive GEMM N=%lld: %.6f s | %.2f GFLOP/s\n",
+           N, pc.seconds, (pc.seconds > 0.0) ? 2.0 * madds / pc.seconds * 1e-9 : 0.0);
+    perfctr_print("gemm (per multiply-add)", &pc, madds, 16.0);
+
     free(A); free(B); free(C);
 }
 
@@ -87,6 +102,7 @@ void multiply_analytic(long long N, double aval, double bval) {
 }
 
 int main(void) {
+    perfctr_init();
     const double AVAL = 3.0;
     const double BVAL = 7.1;
 
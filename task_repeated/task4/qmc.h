@@ -0,0 +1,293 @@
+// qmc.h
+// (Quasi-)Monte Carlo integration over a hyper-rectangle [lo, hi] in dim
+// dimensions, for integrals where the 1D rules of quad.h do not scale.
+//
+//   QMC_SOBOL  : Sobol sequence (Joe–Kuo direction numbers, dim <= QMC_MAXDIM),
+//                Gray-code order, 52-bit points, random digital shift
+//   QMC_HALTON : Halton sequence (radical inverses in the first dim primes),
+//                incremental base-p digit counters, random Cranley–Patterson
+//                shift
+//   QMC_RANDOM : plain Monte Carlo on Philox uniforms (../common/cbrng.h)
+//
+// Error estimate: QMC_REPLICATES independently randomized copies of the
+// sequence are integrated side by side; the spread of the replicate means
+// gives the standard error (randomized QMC). The point count per replicate
+// doubles from QMC_BATCH until the standard error is below
+// max(epsabs, epsrel*|I|) or max_points is reached; a Sobol prefix of 2^m
+// points is a (t,m,s)-net, so the doubling stays on the sizes where it is
+// best balanced.
+//
+// Points are made and evaluated in batches of QMC_BATCH (integrand_nd_fn
+// sees n points at once, row-major n x dim), batches go to OpenMP threads.
+// Each batch sum is stored and the stage total is summed in batch order,
+// so the result is the same for any number of threads.
+
+#ifndef QMC_H
+#define QMC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "quad.h"
+#include "../common/cbrng.h"
+
+// Batch integrand: y[i] = f(x[i*dim .. i*dim+dim-1]) for i < n
+typedef void (*integrand_nd_fn)(const double *x, double *y, size_t n, int dim, void *ctx);
+
+typedef enum { QMC_SOBOL = 0, QMC_HALTON = 1, QMC_RANDOM = 2 } qmc_seq;
+
+#define QMC_MAXDIM 16
+#define QMC_BITS 52
+#define QMC_BATCH 1024
+#define QMC_REPLICATES 8
+#define QMC_HALTON_DIGITS 53   // base-p digits kept: p^K <= 2^53 (K = 53 for p = 2)
+
+// Joe–Kuo (new-joe-kuo-6.21201) primitive polynomials for dimensions 2..16:
+// degree s, coefficient bits a, initial direction numbers m_1..m_s
+static const struct { int s, a, m[6]; } qmc_sobol_poly[QMC_MAXDIM - 1] = {
+    { 1,  0, { 1 } },              { 2,  1, { 1, 3 } },
+    { 3,  1, { 1, 3, 1 } },        { 3,  2, { 1, 1, 1 } },
+    { 4,  1, { 1, 1, 3, 3 } },     { 4,  4, { 1, 3, 5, 13 } },
+    { 5,  2, { 1, 1, 5, 5, 17 } }, { 5,  4, { 1, 1, 5, 5, 5 } },
+    { 5,  7, { 1, 1, 7, 11, 19 } },{ 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } }, { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6,  1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } }
+};
+
+static const int qmc_primes[QMC_MAXDIM] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+
+typedef struct {
+    qmc_seq seq;
+    int dim;
+    uint64_t seed;
+    uint64_t v[QMC_MAXDIM][QMC_BITS];          // Sobol direction numbers, v[d][k] for bit k
+    uint64_t dshift[QMC_REPLICATES][QMC_MAXDIM]; // Sobol digital shifts
+    double shift[QMC_REPLICATES][QMC_MAXDIM];    // Halton shifts in [0,1)
+    int hdigits[QMC_MAXDIM];                     // Halton: K = digits in base p
+    uint64_t hw[QMC_MAXDIM][QMC_HALTON_DIGITS];  // weight p^(K-1-k) of digit k
+    double hscale[QMC_MAXDIM];                   // 1 / p^K
+} qmc_gen;
+
+static inline void qmc_gen_init(qmc_gen *g, qmc_seq seq, int dim, uint64_t seed) {
+    g->seq = seq;
+    g->dim = dim;
+    g->seed = seed;
+    for (int d = 0; d < dim; ++d) {
+        uint64_t *V = g->v[d];            // V[k-1] = m_k << (QMC_BITS - k)
+        if (d == 0) {
+            for (int k = 1; k <= QMC_BITS; ++k) V[k - 1] = 1ULL << (QMC_BITS - k);
+            continue;
+        }
+        int s = qmc_sobol_poly[d - 1].s, a = qmc_sobol_poly[d - 1].a;
+        for (int k = 1; k <= s; ++k) V[k - 1] = (uint64_t)qmc_sobol_poly[d - 1].m[k - 1] << (QMC_BITS - k);
+        for (int k = s + 1; k <= QMC_BITS; ++k) {
+            uint64_t x = V[k - s - 1] ^ (V[k - s - 1] >> s);
+            for (int j = 1; j < s; ++j)
+                if ((a >> (s - 1 - j)) & 1) x ^= V[k - j - 1];
+            V[k - 1] = x;
+        }
+    }
+    // Halton radical inverse of i = N(i) / p^K with the integer N(i) < 2^53
+    for (int d = 0; d < dim; ++d) {
+        uint64_t p = (uint64_t)qmc_primes[d], pk = 1;
+        int K = 0;
+        while (K < QMC_HALTON_DIGITS && pk <= (1ULL << 53) / p) { pk *= p; ++K; }
+        g->hdigits[d] = K;
+        g->hscale[d] = 1.0 / (double)pk;
+        for (int k = 0; k < K; ++k) { pk /= p; g->hw[d][k] = pk; }
+    }
+    // shifts: Philox stream 0x4000 + r, counter d (independent of the points)
+    for (int r = 0; r < QMC_REPLICATES; ++r) {
+        for (int d = 0; d < dim; ++d) {
+            uint64_t w0, w1;
+            cbrng_bits(seed, 0x4000u + (uint32_t)r, (uint64_t)d, &w0, &w1);
+            g->dshift[r][d] = w0 >> (64 - QMC_BITS);
+            g->shift[r][d] = cbrng_u01(w1);
+        }
+    }
+}
+
+// Points i0 .. i0+n-1 of replicate r, mapped to [lo, hi], into x (n x dim).
+static inline void qmc_points(const qmc_gen *g, int r, uint64_t i0, size_t n,
+                              const double *lo, const double *hi, double *x) {
+    int dim = g->dim;
+    if (g->seq == QMC_SOBOL) {
+        // point i is Sobol index gray(i) = i ^ (i >> 1); successive Gray codes
+        // differ in bit ctz(i+1), so each point is one XOR away from the last
+        uint64_t X[QMC_MAXDIM];
+        uint64_t gi = i0 ^ (i0 >> 1);
+        for (int d = 0; d < dim; ++d) {
+            uint64_t acc = 0;
+            for (int k = 0; k < QMC_BITS && (gi >> k); ++k)
+                if ((gi >> k) & 1) acc ^= g->v[d][k];
+            X[d] = acc;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            for (int d = 0; d < dim; ++d) {
+                double u = ((double)(X[d] ^ g->dshift[r][d]) + 0.5) * (1.0 / 4503599627370496.0);
+                x[j * (size_t)dim + (size_t)d] = lo[d] + (hi[d] - lo[d]) * u;
+            }
+            uint64_t next = i0 + j + 1;
+            int c = 0;
+            while (!((next >> c) & 1)) ++c;
+            for (int d = 0; d < dim; ++d) X[d] ^= g->v[d][c];
+        }
+    } else if (g->seq == QMC_HALTON) {
+        // point i is the radical inverse of i + 1; the base-p digits of the
+        // first index are found once, after that counting up is a carry-add
+        // on the digits and moves N by whole digit weights (exact integers)
+        unsigned char dig[QMC_MAXDIM][QMC_HALTON_DIGITS];
+        uint64_t N[QMC_MAXDIM];
+        for (int d = 0; d < dim; ++d) {
+            uint64_t p = (uint64_t)qmc_primes[d], i = i0 + 1;
+            N[d] = 0;
+            for (int k = 0; k < g->hdigits[d]; ++k, i /= p) {
+                dig[d][k] = (unsigned char)(i % p);
+                N[d] += dig[d][k] * g->hw[d][k];
+            }
+        }
+        for (size_t j = 0; j < n; ++j) {
+            for (int d = 0; d < dim; ++d) {
+                double u = (double)N[d] * g->hscale[d] + g->shift[r][d];
+                if (u >= 1.0) u -= 1.0;
+                x[j * (size_t)dim + (size_t)d] = lo[d] + (hi[d] - lo[d]) * u;
+            }
+            for (int d = 0; d < dim; ++d) {
+                const unsigned char top = (unsigned char)(qmc_primes[d] - 1);
+                int k = 0;
+                for (; k < g->hdigits[d] && dig[d][k] == top; ++k) {
+                    dig[d][k] = 0;
+                    N[d] -= top * g->hw[d][k];
+                }
+                if (k < g->hdigits[d]) { ++dig[d][k]; N[d] += g->hw[d][k]; }
+            }
+        }
+    } else {
+        // coordinate d of point i = element i*dim + d of Philox stream r
+        cbrng_fill_uniform(g->seed, (uint32_t)r, (i0) * (uint64_t)dim, n * (size_t)dim, x);
+        for (size_t j = 0; j < n; ++j)
+            for (int d = 0; d < dim; ++d)
+                x[j * (size_t)dim + (size_t)d] = lo[d] + (hi[d] - lo[d]) * x[j * (size_t)dim + (size_t)d];
+    }
+}
+
+// One row per doubling stage, like quad_level for Romberg
+typedef struct {
+    long long npoints;  // points per replicate so far
+    long long neval;    // total evaluations (all replicates)
+    double value;       // mean of the replicate estimates
+    double se;          // standard error of that mean
+} qmc_stage;
+
+#define QMC_STAGES_MAX 48
+
+// Integrates f over [lo, hi]. max_points = cap on points per replicate.
+// If stages != NULL it gets one row per stage; res->intervals = number of
+// stages, res->abserr = standard error. Returns 0 (tolerance met), 1 (point
+// cap hit) or -1 (bad arguments / no memory).
+static inline int qmc_integrate(integrand_nd_fn f, void *ctx, int dim,
+                                const double *lo, const double *hi,
+                                qmc_seq seq, uint64_t seed,
+                                double epsabs, double epsrel, long long max_points,
+                                qmc_stage *stages, quad_result *res) {
+    res->value = NAN; res->abserr = NAN; res->neval = 0; res->intervals = 0; res->status = -1;
+    if (dim < 1 || dim > QMC_MAXDIM) return -1;
+    qmc_gen *g = (qmc_gen*) malloc(sizeof(qmc_gen));
+    if (!g) return -1;
+    qmc_gen_init(g, seq, dim, seed);
+
+    double vol = 1.0;
+    for (int d = 0; d < dim; ++d) vol *= hi[d] - lo[d];
+
+    double sum[QMC_REPLICATES], comp[QMC_REPLICATES];
+    for (int r = 0; r < QMC_REPLICATES; ++r) { sum[r] = 0.0; comp[r] = 0.0; }
+
+    long long done = 0, stage_n = QMC_BATCH;
+    double *bs = NULL;
+    int status = 1, nst = 0;
+    double mean = NAN, se = NAN;
+    while (done + stage_n <= max_points || done == 0) {
+        long long nb = stage_n / QMC_BATCH;
+        double *nbs = (double*) realloc(bs, (size_t)nb * QMC_REPLICATES * sizeof(double));
+        if (!nbs) { free(bs); free(g); return -1; }
+        bs = nbs;
+        int failed = 0;
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+            double *x = (double*) malloc((size_t)QMC_BATCH * (size_t)dim * sizeof(double));
+            double *y = (double*) malloc((size_t)QMC_BATCH * sizeof(double));
+            if (!x || !y) {
+#ifdef _OPENMP
+                #pragma omp atomic write
+#endif
+                failed = 1;
+            }
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic, 1) collapse(2)
+#endif
+            for (long long b = 0; b < nb; ++b) {
+                for (int r = 0; r < QMC_REPLICATES; ++r) {
+                    if (!x || !y) continue;
+                    qmc_points(g, r, (uint64_t)(done + b * QMC_BATCH), QMC_BATCH, lo, hi, x);
+                    f(x, y, QMC_BATCH, dim, ctx);
+                    double s = 0.0, c = 0.0;            // Neumaier
+                    for (size_t j = 0; j < QMC_BATCH; ++j) {
+                        double t = s + y[j];
+                        if (fabs(s) >= fabs(y[j])) c += (s - t) + y[j];
+                        else                       c += (y[j] - t) + s;
+                        s = t;
+                    }
+                    bs[b * QMC_REPLICATES + r] = s + c;
+                }
+            }
+            free(y); free(x);
+        }
+        if (failed) { free(bs); free(g); return -1; }
+
+        // batch sums in batch order: same bits for any thread count
+        for (long long b = 0; b < nb; ++b) {
+            for (int r = 0; r < QMC_REPLICATES; ++r) {
+                double v = bs[b * QMC_REPLICATES + r];
+                double t = sum[r] + v;
+                if (fabs(sum[r]) >= fabs(v)) comp[r] += (sum[r] - t) + v;
+                else                         comp[r] += (v - t) + sum[r];
+                sum[r] = t;
+            }
+        }
+        done += stage_n;
+
+        double est[QMC_REPLICATES];
+        mean = 0.0;
+        for (int r = 0; r < QMC_REPLICATES; ++r) {
+            est[r] = vol * (sum[r] + comp[r]) / (double)done;
+            mean += est[r];
+        }
+        mean /= QMC_REPLICATES;
+        double var = 0.0;
+        for (int r = 0; r < QMC_REPLICATES; ++r) var += (est[r] - mean) * (est[r] - mean);
+        se = sqrt(var / (QMC_REPLICATES - 1) / QMC_REPLICATES);
+
+        if (stages && nst < QMC_STAGES_MAX)
+            stages[nst] = (qmc_stage){ done, done * QMC_REPLICATES, mean, se };
+        ++nst;
+        if (se <= fmax(epsabs, epsrel * fabs(mean))) { status = 0; break; }
+        stage_n = done;                          // next stage doubles the total
+        if (nst >= QMC_STAGES_MAX) break;
+    }
+    free(bs);
+    free(g);
+
+    res->value = mean;
+    res->abserr = se;
+    res->neval = done * QMC_REPLICATES;
+    res->intervals = nst < QMC_STAGES_MAX ? nst : QMC_STAGES_MAX;
+    res->status = status;
+    return status;
+}
+
+#endif // QMC_H
@@ -0,0 +1,277 @@
+// quad.h
+// Integration engines for task4. The integrand is passed as a function
+// pointer plus a user context instead of being hard-wired to f(x).
+//
+//   quad_gk21 : adaptive Gauss–Kronrod 10/21 with a global error estimate.
+//               Subintervals are kept in a max-heap ordered by their error
+//               estimate; the worst one is bisected until the total error
+//               is below max(epsabs, epsrel*|I|).
+//   quad_romberg : nested trapezoid grids (each level doubles the grid and
+//               only evaluates the new midpoints) + Richardson extrapolation.
+//               Level k of the trapezoid column is the plain trapezoidal
+//               rule with 2^k+1 points, so one run is a whole convergence
+//               study for the price of its finest level.
+//   quad_trap_chunk_sums : trapezoid grid with 64-bit indices (N >> 2^31),
+//               cut into fixed chunks of QUAD_TRAP_CHUNK points; each chunk
+//               gets a Neumaier-compensated sum (multi-lane per batch,
+//               ../common/sumlib.h), chunks are spread over
+//               OpenMP threads. Combining the chunk sums with a fixed tree
+//               (../common/repro_sum.h) makes the result independent of the
+//               number of threads or ranks.
+
+#ifndef QUAD_H
+#define QUAD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "../common/sumlib.h"
+
+typedef double (*integrand_fn)(double x, void *ctx);
+// Batch form: y[i] = f(x[i]) for i < n (lets the integrand vectorize)
+typedef void (*integrand_batch_fn)(const double *x, double *y, size_t n, void *ctx);
+
+typedef struct {
+    double value;      // integral estimate
+    double abserr;     // estimated absolute error
+    long long neval;   // number of integrand evaluations
+    int intervals;     // number of subintervals at the end
+    int status;        // 0 = tolerance met, 1 = interval limit hit, -1 = no memory
+} quad_result;
+
+// ---- Gauss–Kronrod 10/21 rule (nodes/weights as in QUADPACK qk21) ----
+static const double gk21_xgk[11] = {
+    0.995657163025808080735527280689003, 0.973906528517171720077964012084452,
+    0.930157491355708226001207180059508, 0.865063366688984510732096688423493,
+    0.780817726586416897063717578345042, 0.679409568299024406234327365114874,
+    0.562757134668604683339000099272694, 0.433395394129247190799265943165784,
+    0.294392862701460198131126603103866, 0.148874338981631210884826001129720,
+    0.000000000000000000000000000000000
+};
+static const double gk21_wgk[11] = {
+    0.011694638867371874278064396062192, 0.032558162307964727478818972459390,
+    0.054755896574351996031381300244580, 0.075039674810919952767043140916190,
+    0.093125454583697605535065465083366, 0.109387158802297641899210590325805,
+    0.123491976262065851077208091651400, 0.134709217311473325928054001771707,
+    0.142775938577060080797094273138717, 0.147739104901338491374841515972068,
+    0.149445554002916905664936468389821
+};
+// 10-point Gauss weights for the nodes xgk[1], xgk[3], ..., xgk[9]
+static const double gk21_wg[5] = {
+    0.066671344308688137593568809893332, 0.149451349150580593145776339657697,
+    0.219086362515982043995534934228163, 0.269266719309996355091226921569469,
+    0.295524224714752870173892994651957
+};
+
+// One GK21 panel on [a,b]: returns the Kronrod value, *err gets the error
+// estimate (QUADPACK scaling of |K - G|). Costs 21 evaluations.
+static inline double quad_gk21_panel(integrand_fn f, void *ctx, double a, double b, double *err) {
+    double c = 0.5 * (a + b), h = 0.5 * (b - a), ah = fabs(h);
+    double fc = f(c, ctx);
+    double resk = fc * gk21_wgk[10], resg = 0.0, resabs = fabs(resk);
+    double fv1[10], fv2[10];
+    for (int j = 0; j < 10; ++j) {
+        double dx = h * gk21_xgk[j];
+        double f1 = f(c - dx, ctx), f2 = f(c + dx, ctx);
+        fv1[j] = f1; fv2[j] = f2;
+        resk += gk21_wgk[j] * (f1 + f2);
+        resabs += gk21_wgk[j] * (fabs(f1) + fabs(f2));
+        if (j & 1) resg += gk21_wg[j / 2] * (f1 + f2);
+    }
+    double reskh = 0.5 * resk;
+    double resasc = gk21_wgk[10] * fabs(fc - reskh);
+    for (int j = 0; j < 10; ++j)
+        resasc += gk21_wgk[j] * (fabs(fv1[j] - reskh) + fabs(fv2[j] - reskh));
+    resk *= h; resabs *= ah; resasc *= ah;
+
+    double e = fabs((resk - resg * h));
+    if (resasc != 0.0 && e != 0.0) {
+        double r = pow(200.0 * e / resasc, 1.5);
+        e = resasc * (r < 1.0 ? r : 1.0);
+    }
+    if (resabs > DBL_MIN / (50.0 * DBL_EPSILON)) {
+        double floor_err = 50.0 * DBL_EPSILON * resabs;
+        if (e < floor_err) e = floor_err;
+    }
+    *err = e;
+    return resk;
+}
+
+// ---- max-heap of subintervals keyed on the error estimate ----
+typedef struct { double a, b, value, err; } quad_interval;
+
+static inline void quad_heap_push(quad_interval *h, int *n, quad_interval iv) {
+    int i = (*n)++;
+    h[i] = iv;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (h[p].err >= h[i].err) break;
+        quad_interval t = h[p]; h[p] = h[i]; h[i] = t;
+        i = p;
+    }
+}
+
+static inline quad_interval quad_heap_pop(quad_interval *h, int *n) {
+    quad_interval top = h[0];
+    h[0] = h[--(*n)];
+    int i = 0;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < *n && h[l].err > h[m].err) m = l;
+        if (r < *n && h[r].err > h[m].err) m = r;
+        if (m == i) break;
+        quad_interval t = h[m]; h[m] = h[i]; h[i] = t;
+        i = m;
+    }
+    return top;
+}
+
+// Adaptive GK21 on [a,b]. Stops when the summed error estimate is below
+// max(epsabs, epsrel*|I|) or after max_intervals subintervals.
+// epsrel is clamped to 50*DBL_EPSILON: below that the per-panel roundoff
+// floor dominates and bisecting further cannot lower the estimate.
+static inline int quad_gk21(integrand_fn f, void *ctx, double a, double b,
+                            double epsabs, double epsrel, int max_intervals,
+                            quad_result *res) {
+    if (max_intervals < 1) max_intervals = 1;
+    if (epsrel < 50.0 * DBL_EPSILON) epsrel = 50.0 * DBL_EPSILON;
+    quad_interval *heap = (quad_interval*) malloc((size_t)max_intervals * sizeof(quad_interval));
+    if (!heap) { res->status = -1; return -1; }
+
+    int n = 0;
+    quad_interval iv = { a, b, 0.0, 0.0 };
+    iv.value = quad_gk21_panel(f, ctx, a, b, &iv.err);
+    quad_heap_push(heap, &n, iv);
+    long long neval = 21;
+    double total = iv.value, total_err = iv.err;
+
+    int status = 0;
+    for (;;) {
+        double tol = fmax(epsabs, epsrel * fabs(total));
+        if (total_err <= tol) break;
+        if (n + 1 > max_intervals) { status = 1; break; }
+
+        quad_interval w = quad_heap_pop(heap, &n);
+        double m = 0.5 * (w.a + w.b);
+        quad_interval l = { w.a, m, 0.0, 0.0 }, r = { m, w.b, 0.0, 0.0 };
+        l.value = quad_gk21_panel(f, ctx, l.a, l.b, &l.err);
+        r.value = quad_gk21_panel(f, ctx, r.a, r.b, &r.err);
+        neval += 42;
+        total += (l.value + r.value) - w.value;
+        total_err += (l.err + r.err) - w.err;
+        quad_heap_push(heap, &n, l);
+        quad_heap_push(heap, &n, r);
+    }
+
+    // re-sum from the heap so the running updates do not leave drift behind
+    total = 0.0; total_err = 0.0;
+    for (int i = 0; i < n; ++i) { total += heap[i].value; total_err += heap[i].err; }
+
+    res->value = total;
+    res->abserr = total_err;
+    res->neval = neval;
+    res->intervals = n;
+    res->status = status;
+    free(heap);
+    return status;
+}
+
+// ---- Romberg ----
+typedef struct {
+    int level;          // k: grid of 2^k panels
+    long long neval;    // cumulative evaluations up to this level
+    double trap;        // trapezoidal rule T_k with 2^k+1 points
+    double romberg;     // extrapolated R[k][k]
+    double delta;       // |R[k][k] - R[k-1][k-1]| (error estimate)
+} quad_level;
+
+#define QUAD_ROMBERG_MAX 32
+
+// Romberg on [a,b] until |R[k][k] - R[k-1][k-1]| <= max(epsabs, epsrel*|R[k][k]|)
+// (checked from level 2 on) or max_levels is reached. If levels != NULL,
+// levels[0..k] gets one row per level; returns the number of rows in
+// res->intervals (= number of levels).
+static inline int quad_romberg(integrand_fn f, void *ctx, double a, double b,
+                               double epsabs, double epsrel, int max_levels,
+                               quad_level *levels, quad_result *res) {
+    if (max_levels < 2) max_levels = 2;
+    if (max_levels > QUAD_ROMBERG_MAX) max_levels = QUAD_ROMBERG_MAX;
+    double prev[QUAD_ROMBERG_MAX], cur[QUAD_ROMBERG_MAX];
+
+    double h = b - a;
+    prev[0] = 0.5 * h * (f(a, ctx) + f(b, ctx));
+    long long neval = 2;
+    if (levels) levels[0] = (quad_level){ 0, neval, prev[0], prev[0], NAN };
+
+    int status = 1, k;
+    double delta = NAN;
+    for (k = 1; k < max_levels; ++k) {
+        // new midpoints only: a + (2i+1)*h/2, i = 0..2^(k-1)-1
+        long long nnew = 1LL << (k - 1);
+        double hk = 0.5 * h, s = 0.0;
+        for (long long i = 0; i < nnew; ++i) s += f(a + (double)(2 * i + 1) * hk, ctx);
+        neval += nnew;
+        cur[0] = 0.5 * prev[0] + hk * s;
+        h = hk;
+
+        // Richardson: R[k][j] = R[k][j-1] + (R[k][j-1] - R[k-1][j-1]) / (4^j - 1)
+        double p4 = 1.0;
+        for (int j = 1; j <= k; ++j) {
+            p4 *= 4.0;
+            cur[j] = cur[j - 1] + (cur[j - 1] - prev[j - 1]) / (p4 - 1.0);
+        }
+        delta = fabs(cur[k] - prev[k - 1]);
+        if (levels) levels[k] = (quad_level){ k, neval, cur[0], cur[k], delta };
+        for (int j = 0; j <= k; ++j) prev[j] = cur[j];
+
+        if (k >= 2 && delta <= fmax(epsabs, epsrel * fabs(cur[k]))) { status = 0; break; }
+    }
+    if (k == max_levels) k = max_levels - 1;
+
+    res->value = prev[k];
+    res->abserr = delta;
+    res->neval = neval;
+    res->intervals = k + 1;
+    res->status = status;
+    return status;
+}
+
+// ---- chunked, compensated trapezoid (64-bit indices) ----
+#define QUAD_TRAP_CHUNK 65536LL
+#define QUAD_TRAP_BATCH 512
+
+static inline long long quad_trap_nchunks(long long N) {
+    return (N + QUAD_TRAP_CHUNK - 1) / QUAD_TRAP_CHUNK;
+}
+
+// sums[c - c0] = sum of w_i f(x_i) over chunk c, for c in [c0, c0+nc), on the
+// N-point grid x_i = a + i*h, h = (b-a)/(N-1), w = 1/2 at both ends and 1
+// elsewhere (multiply the combined sum by h). Chunks go to OpenMP threads;
+// each chunk is summed the same way whichever thread takes it.
+static inline void quad_trap_chunk_sums(integrand_batch_fn fb, void *ctx,
+                                        double a, double b, long long N,
+                                        long long c0, long long nc, double *sums) {
+    double h = (b - a) / (double)(N - 1);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 4)
+#endif
+    for (long long c = c0; c < c0 + nc; ++c) {
+        long long i0 = c * QUAD_TRAP_CHUNK;
+        long long i1 = (i0 + QUAD_TRAP_CHUNK < N) ? i0 + QUAD_TRAP_CHUNK : N;
+        double xb[QUAD_TRAP_BATCH], fv[QUAD_TRAP_BATCH];
+        sum_acc s = { 0.0, 0.0 };
+        for (long long j0 = i0; j0 < i1; j0 += QUAD_TRAP_BATCH) {
+            size_t n = (size_t)((i1 - j0 < QUAD_TRAP_BATCH) ? i1 - j0 : QUAD_TRAP_BATCH);
+            for (size_t j = 0; j < n; ++j) xb[j] = a + (double)(j0 + (long long)j) * h;
+            fb(xb, fv, n, ctx);
+            if (j0 == 0) fv[0] *= 0.5;
+            if (j0 + (long long)n == N) fv[n - 1] *= 0.5;
+            sum_acc_merge(&s, sum_neumaier_acc(fv, n));
+        }
+        sums[c - c0] = s.s + s.c;
+    }
+}
+
+#endif // QUAD_H
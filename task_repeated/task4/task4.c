@@ -1,19 +1,107 @@
+// task4.c — f(x) = e^x cos(x): samples to task4_output.txt + integral on [0, pi/2]
+// Build: gcc -O3 -march=native -fopenmp-simd -std=c11 task4.c -o task4 -lm
+//   (one thread in par mode; for OpenMP threads use -fopenmp instead:
+//    gcc -O3 -march=native -fopenmp -std=c11 task4.c -o task4 -lm)
+// Run:   ./task4 N x_inf x_sup [trap|gk|romberg|batch|par] [tol]
+//        ./task4 N x_inf x_sup qmc [tol] [dim] [sobol|halton|random]
+// par mode with MPI ranks as well as threads:
+//        mpicc -DUSE_MPI -O3 -march=native -fopenmp -std=c11 task4.c -o task4_mpi -lm
+//        mpirun -np 4 ./task4_mpi 1e10 0 1.5707963267948966 par
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/bench.h"
+#include "quad.h"
+#include "qmc.h"
+#include "../common/vmath.h"
+#include "../common/repro_sum.h"
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 // Function definition f(x) = e^x * cos(x)
 double f(double x) {
     return exp(x) * cos(x);
 }
 
+// Same integrand in the (x, ctx) form used by the engines in quad.h
+static double f_ctx(double x, void *ctx) {
+    (void)ctx;
+    return f(x);
+}
+
+// Batch form: y[i] = f(x[i]) for a whole array, using the vectorizable
+// exp/cos from vmath.h (<= 1 ulp exp, <= 2 ulp cos; product within ~3 ulp
+// of the libm f(x))
+static void f_batch(const double *x, double *y, size_t n, void *ctx) {
+    (void)ctx;
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) y[i] = vm_exp(x[i]) * vm_cos(x[i]);
+}
+
+// dim-dimensional test integrand prod_d f(x_d): the integral over a cube
+// [a,b]^dim is (F(b) - F(a))^dim; dim = 1 is the task4 integrand itself
+static void f_nd(const double *x, double *y, size_t n, int dim, void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; ++i) {
+        double p = 1.0;
+        for (int d = 0; d < dim; ++d) {
+            double t = x[i * (size_t)dim + (size_t)d];
+            p *= vm_exp(t) * vm_cos(t);
+        }
+        y[i] = p;
+    }
+}
+
+// Antiderivative of f, for the analytic value on any [a,b]
+static double F(double x) {
+    return 0.5 * exp(x) * (sin(x) + cos(x));
+}
+
+#define SAMPLE_BLOCK 512
+
+// Single pass over the N-point grid on [x_inf, x_sup]: each block of points
+// is evaluated once with fb, written to fp (if not NULL) and added to the
+// trapezoidal sum from the same values.
+static double sample_and_integrate(integrand_batch_fn fb, void *ctx,
+                                   double x_inf, double x_sup, long long N, FILE *fp) {
+    double h = (x_sup - x_inf) / (double)(N - 1);
+    double xb[SAMPLE_BLOCK], fv[SAMPLE_BLOCK];
+    double integral = 0.0;
+    for (long long i0 = 0; i0 < N; i0 += SAMPLE_BLOCK) {
+        size_t n = (size_t)((N - i0 < SAMPLE_BLOCK) ? N - i0 : SAMPLE_BLOCK);
+        for (size_t j = 0; j < n; ++j) xb[j] = x_inf + (double)(i0 + (long long)j) * h;
+        fb(xb, fv, n, ctx);
+        if (fp) {
+            for (size_t j = 0; j < n; ++j) fprintf(fp, "%.8f %.8f\n", xb[j], fv[j]);
+        }
+        double block = 0.0;
+        for (size_t j = 0; j < n; ++j) block += fv[j];
+        if (i0 == 0) block -= 0.5 * fv[0];                // endpoint weights 1/2
+        if (i0 + (long long)n == N) block -= 0.5 * fv[n - 1];
+        integral += block;
+    }
+    return integral * h;
+}
+
 // Numerical integration using trapezoidal rule
-double trapezoidal(double x_inf, double x_sup, int N) {
+double trapezoidal(double x_inf, double x_sup, long long N) {
     double h = (x_sup - x_inf) / (double)(N - 1);
     double integral = 0.0;
 
-    for (int i = 1; i < N - 1; i++) {
-        integral += f(x_inf + i * h);
+    for (long long i = 1; i < N - 1; i++) {
+        integral += f(x_inf + (double)i * h);
     }
 
     integral += (f(x_inf) + f(x_sup)) / 2.0;
@@ -22,15 +110,139 @@ double trapezoidal(double x_inf, double x_sup, int N) {
     return integral;
 }
 
+// par mode: N-point trapezoid on [x_inf, x_sup] over OpenMP threads (and MPI
+// ranks with -DUSE_MPI). Ranks own contiguous ranges of whole chunks; the
+// chunk sums are gathered on rank 0 and combined with the fixed tree, so the
+// printed value has the same bits for any thread/rank count.
+static int run_parallel(int *argc, char ***argv, long long N, double x_inf, double x_sup) {
+    int rank = 0, size = 1;
+#ifdef USE_MPI
+    MPI_Init(argc, argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#else
+    (void)argc; (void)argv;
+#endif
+    long long nchunks = quad_trap_nchunks(N);
+    long long c0 = (long long)rank * (nchunks / size) + (rank < nchunks % size ? rank : nchunks % size);
+    long long nc = nchunks / size + (rank < nchunks % size ? 1 : 0);
+
+    double *sums = (double*) malloc((size_t)(rank == 0 ? nchunks : nc) * sizeof(double) + sizeof(double));
+    if (!sums) {
+        fprintf(stderr, "Allocation of %lld chunk sums failed\n", nchunks);
+#ifdef USE_MPI
+        MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+        return 1;
+    }
+
+    double t0 = bench_now();
+    quad_trap_chunk_sums(f_batch, NULL, x_inf, x_sup, N, c0, nc, sums);
+#ifdef USE_MPI
+    int *counts = (int*) malloc((size_t)size * sizeof(int));
+    int *displs = (int*) malloc((size_t)size * sizeof(int));
+    if (!counts || !displs) MPI_Abort(MPI_COMM_WORLD, 2);
+    for (int r = 0; r < size; ++r) {
+        counts[r] = (int)(nchunks / size + (r < nchunks % size ? 1 : 0));
+        displs[r] = (int)((long long)r * (nchunks / size) + (r < nchunks % size ? r : nchunks % size));
+    }
+    MPI_Gatherv(rank == 0 ? MPI_IN_PLACE : sums, (int)nc, MPI_DOUBLE,
+                sums, counts, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    free(displs); free(counts);
+#endif
+
+    if (rank == 0) {
+        // only rank 0 holds all nchunks sums (the others allocated nc)
+        double I = repro_tree(sums, (size_t)nchunks) * ((x_sup - x_inf) / (double)(N - 1));
+        double t1 = bench_now();
+        int threads = 1;
+#ifdef _OPENMP
+        threads = omp_get_max_threads();
+#else
+        printf("(built without -fopenmp: par mode runs one thread per rank)\n");
+#endif
+        double I_true = F(x_sup) - F(x_inf);
+        printf("Numerical Integral I  = %.16f   (on [%g, %g])\n", I, x_inf, x_sup);
+        printf("Analytic Solution     = %.16f\n", I_true);
+        printf("Relative Error        = %.16e\n", I / I_true - 1.0);
+        printf("Function evaluations  = %lld (%lld chunks of %lld)\n", N, nchunks, QUAD_TRAP_CHUNK);
+        printf("[TIME] parallel trapezoid: %.6f s | ranks: %d | threads/rank: %d | %.3f ns/point\n",
+               t1 - t0, size, threads, 1e9 * (t1 - t0) / (double)N);
+    }
+    free(sums);
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
+    return 0;
+}
+
+// qmc mode: (quasi-)Monte Carlo over [x_inf, x_sup]^dim with replicate error
+// estimate, doubling the points until tol (relative) or N points per replicate
+static int run_qmc(long long N, double x_inf, double x_sup, double tol, int dim, const char *seqname) {
+    qmc_seq seq = QMC_SOBOL;
+    if (strcmp(seqname, "halton") == 0) seq = QMC_HALTON;
+    else if (strcmp(seqname, "random") == 0) seq = QMC_RANDOM;
+    else if (strcmp(seqname, "sobol") != 0) {
+        fprintf(stderr, "Unknown sequence '%s' (use sobol, halton or random)\n", seqname);
+        return 1;
+    }
+    double lo[QMC_MAXDIM], hi[QMC_MAXDIM];
+    for (int d = 0; d < dim && d < QMC_MAXDIM; ++d) { lo[d] = x_inf; hi[d] = x_sup; }
+
+    qmc_stage st[QMC_STAGES_MAX];
+    quad_result r;
+    double t0 = bench_now();
+    int rc = qmc_integrate(f_nd, NULL, dim, lo, hi, seq, 12345, 0.0, tol, N, st, &r);
+    double t1 = bench_now();
+    if (rc < 0) {
+        fprintf(stderr, "qmc_integrate: dim must be 1..%d (or allocation failed)\n", QMC_MAXDIM);
+        return 1;
+    }
+    if (rc > 0) fprintf(stderr, "qmc_integrate: point limit reached, tolerance not met\n");
+
+    double I_true = pow(F(x_sup) - F(x_inf), dim);
+    printf("%12s %14s %24s %12s %12s\n", "points/rep", "f evals", "estimate", "std.err", "true relerr");
+    for (int k = 0; k < r.intervals; ++k)
+        printf("%12lld %14lld %24.16f %12.3e %12.3e\n", st[k].npoints, st[k].neval,
+               st[k].value, st[k].se, st[k].value / I_true - 1.0);
+    printf("Numerical Integral I  = %.16f   (%s, dim %d, on [%g, %g]^%d)\n",
+           r.value, seqname, dim, x_inf, x_sup, dim);
+    printf("Analytic Solution     = %.16f\n", I_true);
+    printf("Relative Error        = %.16e   (estimated %.3e)\n", r.value / I_true - 1.0, r.abserr / fabs(r.value));
+    printf("Function evaluations  = %lld (%d randomized replicates)\n", r.neval, QMC_REPLICATES);
+    printf("[TIME] qmc: %.6f s | %.3f ns/eval\n", t1 - t0, 1e9 * (t1 - t0) / (double)r.neval);
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        printf("Usage: %s N x_inf x_sup\n", argv[0]);
+    if (argc < 4 || argc > 8) {
+        printf("Usage: %s N x_inf x_sup [trap|gk|romberg|batch|par|qmc] [tol]\n", argv[0]);
+        printf("  trap    : trapezoidal rule with N points (default)\n");
+        printf("  gk      : adaptive Gauss-Kronrod 10/21 to relative tolerance tol (default 1e-12)\n");
+        printf("  romberg : nested trapezoid levels + Richardson, prints error per level\n");
+        printf("  batch   : one vectorized pass that writes the samples and integrates\n");
+        printf("            them on [x_inf, x_sup] (checked against the antiderivative)\n");
+        printf("  par     : 64-bit N (e.g. 1e10), threads (+ MPI ranks), compensated\n");
+        printf("            chunk sums combined deterministically; no sample file\n");
+        printf("  qmc     : [tol] [dim] [sobol|halton|random]: quasi-Monte Carlo of\n");
+        printf("            prod f(x_d) on [x_inf, x_sup]^dim, at most N points per replicate\n");
         return 1;
     }
 
-    int N = atoi(argv[1]);
+    long long N = (long long)strtod(argv[1], NULL);   // accepts 1e10
     double x_inf = atof(argv[2]);
     double x_sup = atof(argv[3]);
+    const char *method = (argc > 4) ? argv[4] : "trap";
+    double tol = (argc > 5) ? atof(argv[5]) : 1e-12;
+    if (N < 2) {
+        fprintf(stderr, "N must be >= 2\n");
+        return 1;
+    }
+
+    // par mode skips the sample file (N = 1e10 would be ~250 GB of text)
+    if (strcmp(method, "par") == 0) return run_parallel(&argc, &argv, N, x_inf, x_sup);
+    if (strcmp(method, "qmc") == 0)
+        return run_qmc(N, x_inf, x_sup, tol, (argc > 6) ? atoi(argv[6]) : 1, (argc > 7) ? argv[7] : "sobol");
 
     // Write sampled values to file
     FILE *fp = fopen("task4_output.txt", "w");
@@ -39,25 +251,72 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (strcmp(method, "batch") == 0) {
+        clock_t c0 = clock();
+        double Ib = sample_and_integrate(f_batch, NULL, x_inf, x_sup, N, fp);
+        clock_t c1 = clock();
+        fclose(fp);
+        double Ib_true = F(x_sup) - F(x_inf);
+        printf("Numerical Integral I  = %.16f   (on [%g, %g])\n", Ib, x_inf, x_sup);
+        printf("Analytic Solution     = %.16f\n", Ib_true);
+        printf("Relative Error        = %.16e\n", Ib / Ib_true - 1.0);
+        printf("Function evaluations  = %lld (shared by file and integral)\n", N);
+        printf("[TIME] sample + integrate: %.6f s\n", (double)(c1 - c0) / CLOCKS_PER_SEC);
+        return 0;
+    }
+
     double h = (x_sup - x_inf) / (double)(N - 1);
-    for (int i = 0; i < N; i++) {
-        double x = x_inf + i * h;
+    for (long long i = 0; i < N; i++) {
+        double x = x_inf + (double)i * h;
         fprintf(fp, "%.8f %.8f\n", x, f(x));
     }
     fclose(fp);
 
-    // Compute numerical integral
-    double I = trapezoidal(0.0, M_PI/2.0, N);
-
     // Analytic solution
     double I_true = (exp(M_PI/2.0) - 1.0) / 2.0;
 
+    // Compute numerical integral
+    double I;
+    long long neval;
+    if (strcmp(method, "gk") == 0) {
+        quad_result r;
+        int st = quad_gk21(f_ctx, NULL, 0.0, M_PI/2.0, 0.0, tol, 1000, &r);
+        if (st < 0) { fprintf(stderr, "quad_gk21: allocation failed\n"); return 1; }
+        if (st > 0) fprintf(stderr, "quad_gk21: interval limit reached, tolerance not met\n");
+        I = r.value;
+        neval = r.neval;
+        printf("GK21: %d subintervals, estimated abs error = %.3e\n", r.intervals, r.abserr);
+    } else if (strcmp(method, "romberg") == 0) {
+        quad_level lv[QUAD_ROMBERG_MAX];
+        quad_result r;
+        quad_romberg(f_ctx, NULL, 0.0, M_PI/2.0, 0.0, tol, QUAD_ROMBERG_MAX, lv, &r);
+        if (r.status) fprintf(stderr, "quad_romberg: level limit reached, tolerance not met\n");
+        // Trapezoid column = convergence study of the plain rule, for free
+        printf("%5s %12s %12s %24s %24s %12s %12s\n", "level", "points", "f evals",
+               "trapezoid T_k", "Romberg R_kk", "trap relerr", "Romb relerr");
+        for (int k = 0; k < r.intervals; ++k) {
+            printf("%5d %12lld %12lld %24.16f %24.16f %12.3e %12.3e\n",
+                   lv[k].level, (1LL << lv[k].level) + 1, lv[k].neval,
+                   lv[k].trap, lv[k].romberg,
+                   lv[k].trap / I_true - 1.0, lv[k].romberg / I_true - 1.0);
+        }
+        I = r.value;
+        neval = r.neval;
+    } else if (strcmp(method, "trap") == 0) {
+        I = trapezoidal(0.0, M_PI/2.0, N);
+        neval = N;
+    } else {
+        fprintf(stderr, "Unknown method '%s' (use trap, gk, romberg, batch, par or qmc)\n", method);
+        return 1;
+    }
+
     // Relative error
     double eps_rel = (I / I_true) - 1.0;
 
     printf("Numerical Integral I  = %.16f\n", I);
     printf("Analytic Solution     = %.16f\n", I_true);
     printf("Relative Error        = %.16e\n", eps_rel);
+    printf("Function evaluations  = %lld\n", neval);
 
     return 0;
 }
@@ -1,4 +1,8 @@
+// task5.c — naive vs correctly rounded sum of the assignment vector
+// Build: gcc -O2 -std=c11 task5.c -o task5 -lm
 #include <stdio.h>
+#include "../common/exactsum.h"
+
 int main(void) {
     // Vector from the assignment
     double vec[] = {1.0, 1.0e16, -1.0e16, -0.5};
@@ -11,5 +15,8 @@ int main(void) {
 
     // Print with high precision to see floating-point effects
     printf("Sum (for loop): %.17g\n", sum);
+
+    // Superaccumulator: exact sum, rounded once at the end (= 0.5)
+    printf("Sum (exact)   : %.17g\n", xsum_exact(vec, n));
     return 0;
 }
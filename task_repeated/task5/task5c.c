@@ -1,6 +1,16 @@
 // task5c.c
+// Build: gcc -O3 -march=native -fopenmp -std=c11 task5c.c -o task5c
+// Run:   ./task5c            (assignment vector)
+//        ./task5c 1e8        (+ throughput/accuracy of the ../common/sumlib.h kernels,
+//                             measured against the exact sum of ../common/exactsum.h)
 #include <stdio.h>
+#include <stdlib.h>
 #include <stddef.h>
+#include <math.h>
+#include <omp.h>
+
+#include "../common/sumlib.h"
+#include "../common/exactsum.h"
 
 double kahan_sum(const double *a, size_t n) {
     double sum = 0.0;
@@ -20,7 +30,46 @@ double naive_sum(const double *a, size_t n) {
     return s;
 }
 
-int main(void) {
+typedef double (*sum_fn)(const double *, size_t);
+
+static void bench_sums(size_t n) {
+    double *a = (double*) malloc(n * sizeof(double));
+    if (!a) { fprintf(stderr, "Allocation failed\n"); return; }
+    // ill-conditioned on purpose: large +/- values that cancel, plus small ones
+    unsigned long long seed = 42;
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 2862933555777941757ULL + 3037000493ULL;
+        double r = (double)(seed >> 11) / (double)(1ULL << 53);   // [0,1)
+        a[i] = ((seed >> 10) & 1 ? -1.0e8 : 1.0e8) * (1.0 + r * 1e-3) + r;
+    }
+    double ref = xsum_exact(a, n);   // correctly rounded: the true reference
+
+    struct { const char *name; sum_fn fn; } k[] = {
+        { "naive",          naive_sum },
+        { "kahan",          kahan_sum },
+        { "kahan_simd",     sum_kahan_simd },
+        { "neumaier_simd",  sum_neumaier_simd },
+        { "pairwise",       sum_pairwise },
+        { "neumaier_omp",   sum_neumaier_omp },
+        { "exact",          xsum_exact },
+        { "exact_omp",      xsum_exact_omp },
+    };
+    printf("N = %zu, threads = %d, reference (exact, rounded once) = %.17g\n",
+           n, omp_get_max_threads(), ref);
+    printf("%-14s %12s %10s %12s\n", "kernel", "time[s]", "GB/s", "rel.err");
+    for (size_t j = 0; j < sizeof(k) / sizeof(k[0]); ++j) {
+        k[j].fn(a, n);                       // warm-up
+        double t0 = omp_get_wtime();
+        double s = k[j].fn(a, n);
+        double t1 = omp_get_wtime();
+        double err = fabs((s - ref) / ref);
+        printf("%-14s %12.6f %10.2f %12.3e\n", k[j].name, t1 - t0,
+               8.0 * (double)n / (t1 - t0) / 1e9, err);
+    }
+    free(a);
+}
+
+int main(int argc, char **argv) {
     // Vector from the assignment
     double vec[] = {1.0, 1.0e16, -1.0e16, -0.5};
     size_t n = sizeof(vec) / sizeof(vec[0]);
@@ -31,6 +80,9 @@ int main(void) {
     // Print with high precision to see differences
     printf("Naive sum:  %.17g\n", s_naive);
     printf("Kahan sum:  %.17g\n", s_kahan);
+    printf("Neumaier:   %.17g\n", sum_neumaier_simd(vec, n));
+    printf("Exact:      %.17g\n", xsum_exact(vec, n));
 
+    if (argc > 1) bench_sums((size_t)strtod(argv[1], NULL));
     return 0;
 }
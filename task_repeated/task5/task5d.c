@@ -1,20 +1,41 @@
 // task5d.c — DAXPY with Gaussian vectors and correctness checks
-// Build: gcc -O2 -Wall -std=c11 task5d.c -lm -o task5d
-// Run:   ./task5d [N] [a] [seed]
-//        e.g., ./task5d            (defaults: N=1e6, a=3.0, seed=time)
-//              ./task5d 200000 1.0 42
+// Build: gcc -O3 -march=native -fno-math-errno -Wall -std=c11 -fopenmp task5d.c -lm -o task5d
+//        (statistics in blocks over all threads, see ../common/moments.h)
+// Run:   ./task5d [N] [a] [seed] [bm|zig]
+//        e.g., ./task5d            (defaults: N=1e6, a=3.0, seed=time, bm)
+//              ./task5d 200000 1.0 42 zig
+//        ./task5d stream [N] [a] [seed] [bm|zig]
+//                                  (O(1) memory: blocks of x, y, d are made,
+//                                   checked and dropped; N = 1e10 is fine)
+//        ./task5d bench [N]        (generator throughput: rand()/LCG vs Philox)
+// x and y are Philox streams 0 and 1 of the seed (../common/cbrng.h), turned
+// into normals by batch Box–Muller or the ziggurat (../common/randn.h): the
+// same seed gives the same vectors for any number of threads.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../common/bench.h"
+#include "../common/moments.h"
+#include "../common/cbrng.h"
+#include "../common/randn.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 
-// ---- Gaussian(0,1) via Box–Muller ----
+#define GEN_BLOCK 4096   // even, so threads start on whole Box–Muller pairs
+#define STREAM_BLOCK 2048   // x, y, d blocks: 48 KB per thread, stays in L2
+
+// ---- Gaussian(0,1) via Box–Muller (libc rand(); kept for the benchmark) ----
 static double gauss01(void) {
     // u1 in (0,1], u2 in [0,1)
     double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
@@ -22,63 +43,210 @@ static double gauss01(void) {
     return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
 }
 
-// ---- Online stats (Welford) ----
-typedef struct { long long n; double mean; double M2; } Welford;
+// x ~ N(0,1) from (seed, stream), any thread count gives the same array
+static void fill_normal(double *x, long long N, unsigned long long seed, unsigned stream, randn_method m) {
+    randn_zig zt;
+    randn_zig_init(&zt);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < N; i += GEN_BLOCK) {
+        size_t n = (size_t)((N - i < GEN_BLOCK) ? N - i : GEN_BLOCK);
+        if (m == RANDN_ZIGGURAT) randn_fill_zig(&zt, seed, stream, (uint64_t)i, n, 0.0, 1.0, x + i);
+        else randn_fill_bm(seed, stream, (uint64_t)i, n, 0.0, 1.0, x + i);
+    }
+}
+
+static void fill_uniform(double *x, long long N, unsigned long long seed, unsigned stream) {
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < N; i += GEN_BLOCK) {
+        size_t n = (size_t)((N - i < GEN_BLOCK) ? N - i : GEN_BLOCK);
+        cbrng_fill_uniform(seed, stream, (uint64_t)i, n, x + i);
+    }
+}
+
+// ---- bench: fill N uniforms / normals with each generator ----
+static int run_bench(long long N) {
+    double *x = (double*)malloc(sizeof(double)*N);
+    if(!x){ fprintf(stderr,"[ERROR] Allocation failed\n"); return 1; }
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    printf("N=%lld, threads=%d\n", N, threads);
+    printf("%-26s %10s %10s %12s\n", "generator", "time[s]", "ns/value", "mean");
+    for (int k = 0; k < 10; ++k) {
+        const char *name = "";
+        double t0 = bench_now();
+        switch (k) {
+        case 0: name = "rand() uniform";
+            srand(1);
+            for (long long i = 0; i < N; ++i) x[i] = (rand() + 0.5) / (RAND_MAX + 1.0);
+            break;
+        case 1: { name = "LCG uniform (task9)";
+            unsigned long long st = 42;
+            for (long long i = 0; i < N; ++i) {
+                st = st * 2862933555777941757ULL + 3037000493ULL;
+                x[i] = ((double)(st >> 11) + 0.5) / 9007199254740992.0;
+            }
+            break; }
+        case 2: name = "philox uniform, 1 thread";
+            for (long long i = 0; i < N; i += GEN_BLOCK)
+                cbrng_fill_uniform(1, 0, (uint64_t)i, (size_t)((N - i < GEN_BLOCK) ? N - i : GEN_BLOCK), x + i);
+            break;
+        case 3: name = "philox uniform, threads";
+            fill_uniform(x, N, 1, 0);
+            break;
+        case 4: name = "rand() gauss01";
+            srand(1);
+            for (long long i = 0; i < N; ++i) x[i] = gauss01();
+            break;
+        case 5: { name = "philox + libm BM (cos only)";
+            for (long long i = 0; i < N; ++i) {
+                uint64_t w0, w1;
+                cbrng_bits(1, 0, (uint64_t)i, &w0, &w1);
+                x[i] = sqrt(-2.0 * log(cbrng_u01(w0))) * cos(2.0 * M_PI * cbrng_u01(w1));
+            }
+            break; }
+        case 6: name = "philox BM simd, 1 thread";
+            randn_fill_bm(1, 0, 0, (size_t)N, 0.0, 1.0, x);
+            break;
+        case 7: name = "philox BM simd, threads";
+            fill_normal(x, N, 1, 0, RANDN_BOXMULLER);
+            break;
+        case 8: name = "philox ziggurat, 1 thread";
+            randn_fill(RANDN_ZIGGURAT, 1, 0, 0, (size_t)N, 0.0, 1.0, x);
+            break;
+        case 9: name = "philox ziggurat, threads";
+            fill_normal(x, N, 1, 0, RANDN_ZIGGURAT);
+            break;
+        }
+        double t1 = bench_now();
+        double m = 0.0;
+        for (long long i = 0; i < N; ++i) m += x[i];
+        printf("%-26s %10.4f %10.2f %12.6f\n", name, t1 - t0, 1e9 * (t1 - t0) / (double)N, m / (double)N);
+    }
+    free(x);
+    return 0;
+}
 
-static void w_init(Welford *w){ w->n=0; w->mean=0.0; w->M2=0.0; }
-static void w_push(Welford *w, double x){
-    w->n++;
-    double delta = x - w->mean;
-    w->mean += delta / (double)w->n;
-    double delta2 = x - w->mean;
-    w->M2 += delta * delta2;
+// Streaming generate-compute-verify. Each thread takes a contiguous range
+// of blocks, generates x and y for the block (the same elements as the
+// array mode), forms d and folds the block into its error metrics and
+// moment state; per-thread results are merged in thread order. Nothing of
+// size N is stored and the data never leaves the cache.
+static void stream_checks(long long N, double a, unsigned seed, randn_method gen,
+                          double *max_abs_err, double *l1_err, mom_state *ws) {
+    randn_zig zt;
+    randn_zig_init(&zt);
+    long long nblocks = (N + STREAM_BLOCK - 1) / STREAM_BLOCK;
+    mom_state part[256];
+    double part_max[256], part_l1[256];
+    int nt = 1;
+    #pragma omp parallel
+    {
+        int t = 0, T = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        T = omp_get_num_threads();
+#endif
+        if (T > 256) T = 256;
+        #pragma omp single
+        nt = T;
+        if (t < T) {
+            double xb[STREAM_BLOCK], yb[STREAM_BLOCK], db[STREAM_BLOCK];
+            mom_state st;
+            mom_init(&st);
+            double emax = 0.0, el1 = 0.0;
+            for (long long b = nblocks * t / T; b < nblocks * (t + 1) / T; ++b) {
+                long long i0 = b * STREAM_BLOCK;
+                size_t n = (size_t)((N - i0 < STREAM_BLOCK) ? N - i0 : STREAM_BLOCK);
+                if (gen == RANDN_ZIGGURAT) {
+                    randn_fill_zig(&zt, seed, 0, (uint64_t)i0, n, 0.0, 1.0, xb);
+                    randn_fill_zig(&zt, seed, 1, (uint64_t)i0, n, 0.0, 1.0, yb);
+                } else {
+                    randn_fill_bm(seed, 0, (uint64_t)i0, n, 0.0, 1.0, xb);
+                    randn_fill_bm(seed, 1, (uint64_t)i0, n, 0.0, 1.0, yb);
+                }
+                for (size_t j = 0; j < n; ++j) db[j] = a*xb[j] + yb[j];
+                for (size_t j = 0; j < n; ++j) {
+                    double e = fabs(db[j] - (a*xb[j] + yb[j]));
+                    if (e > emax) emax = e;
+                    el1 += e;
+                }
+                mom_update(&st, db, n);
+            }
+            part[t] = st;
+            part_max[t] = emax;
+            part_l1[t] = el1;
+        }
+    }
+    mom_init(ws);
+    *max_abs_err = 0.0;
+    *l1_err = 0.0;
+    for (int t = 0; t < nt; ++t) {
+        mom_merge(ws, &part[t]);
+        if (part_max[t] > *max_abs_err) *max_abs_err = part_max[t];
+        *l1_err += part_l1[t];
+    }
 }
-static double w_mean(const Welford *w){ return w->mean; }
-static double w_var_sample(const Welford *w){ return (w->n>1)? w->M2/(w->n-1) : NAN; }
 
 int main(int argc, char **argv){
-    // Parameters (all optional): N, a, seed
-    long long N   = (argc>1)? atoll(argv[1]) : 1000000LL;
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        return run_bench((argc > 2) ? (long long)strtod(argv[2], NULL) : 10000000LL);
+    int streaming = (argc > 1 && strcmp(argv[1], "stream") == 0);
+    if (streaming) { argc--; argv++; }
+
+    // Parameters (all optional): N (1e10 notation accepted), a, seed, normal generator
+    long long N   = (argc>1)? (long long)strtod(argv[1],NULL) : 1000000LL;
     double a      = (argc>2)? atof(argv[2])  : 3.0;
     unsigned seed = (argc>3)? (unsigned)strtoul(argv[3],NULL,10) : (unsigned)time(NULL);
+    randn_method gen = (argc>4 && strcmp(argv[4], "zig") == 0) ? RANDN_ZIGGURAT : RANDN_BOXMULLER;
 
-    srand(seed);
+    double max_abs_err = 0.0, l1_err = 0.0;
+    mom_state ws;
+    double t0 = bench_now();
+    if (streaming) {
+        stream_checks(N, a, seed, gen, &max_abs_err, &l1_err, &ws);
+    } else {
+        // Allocate
+        double *x = (double*)malloc(sizeof(double)*N);
+        double *y = (double*)malloc(sizeof(double)*N);
+        double *d = (double*)malloc(sizeof(double)*N);
+        if(!x || !y || !d){
+            fprintf(stderr,"[ERROR] Allocation failed\n");
+            free(x); free(y); free(d);
+            return 1;
+        }
 
-    // Allocate
-    double *x = (double*)malloc(sizeof(double)*N);
-    double *y = (double*)malloc(sizeof(double)*N);
-    double *d = (double*)malloc(sizeof(double)*N);
-    if(!x || !y || !d){
-        fprintf(stderr,"[ERROR] Allocation failed\n");
-        free(x); free(y); free(d);
-        return 1;
-    }
+        // Fill x,y with N(0,1) (independent streams) and compute d = a*x + y
+        fill_normal(x, N, seed, 0, gen);
+        fill_normal(y, N, seed, 1, gen);
+        #pragma omp parallel for schedule(static)
+        for(long long i=0;i<N;i++){
+            d[i] = a*x[i] + y[i];
+        }
 
-    // Fill x,y with N(0,1) and compute d = a*x + y
-    for(long long i=0;i<N;i++){
-        x[i] = gauss01();
-        y[i] = gauss01();
-        d[i] = a*x[i] + y[i];
-    }
+        // -------- Test 1: Deterministic (formula consistency) --------
+        // Verify d[i] == a*x[i] + y[i] within floating-point tolerance
+        for(long long i=0;i<N;i++){
+            double ref = a*x[i] + y[i];
+            double e = fabs(d[i] - ref);
+            if(e > max_abs_err) max_abs_err = e;
+            l1_err += e;
+        }
 
-    // -------- Test 1: Deterministic (formula consistency) --------
-    // Verify d[i] == a*x[i] + y[i] within floating-point tolerance
-    double max_abs_err = 0.0, l1_err = 0.0;
-    for(long long i=0;i<N;i++){
-        double ref = a*x[i] + y[i];
-        double e = fabs(d[i] - ref);
-        if(e > max_abs_err) max_abs_err = e;
-        l1_err += e;
+        // -------- Test 2: Statistical (distribution properties) --------
+        ws = mom_compute_omp(d, (size_t)N);
+        free(x); free(y); free(d);
     }
+    double t1 = bench_now();
 
-    // -------- Test 2: Statistical (distribution properties) --------
     // If x,y ~ N(0,1) independent, then d ~ N(0, a^2 + 1).
     double var_theory = a*a + 1.0;
-    Welford ws; w_init(&ws);
-    for(long long i=0;i<N;i++) w_push(&ws, d[i]);
 
-    double mean_hat = w_mean(&ws);
-    double var_hat  = w_var_sample(&ws);
+    double mean_hat = mom_mean(&ws);
+    double var_hat  = mom_var_sample(&ws);
+    double skew_hat = mom_skewness(&ws);         // 0 for a normal
+    double kurt_hat = mom_kurtosis_excess(&ws);  // 0 for a normal
 
     // Standard error of the sample mean: sqrt(Var(d)/N)
     double se_mean = sqrt(var_theory / (double)N);
@@ -86,17 +254,24 @@ int main(int argc, char **argv){
     // Simple pass/fail checks (practical thresholds)
     int pass_mean = (fabs(mean_hat) <= 3.0*se_mean);              // mean ~ 0 ?
     int pass_var  = (fabs(var_hat - var_theory) <= 0.05*var_theory); // var ~ a^2+1 within ~5%
+    // large-N standard errors of g1, g2 for normal data: sqrt(6/N), sqrt(24/N)
+    double se_skew = sqrt(6.0 / (double)N), se_kurt = sqrt(24.0 / (double)N);
+    int pass_skew = (fabs(skew_hat) <= 4.0*se_skew);
+    int pass_kurt = (fabs(kurt_hat) <= 4.0*se_kurt);
 
     // -------- Report --------
-    printf("N=%lld, a=%.6f, seed=%u\n", N, a, seed);
+    printf("N=%lld, a=%.6f, seed=%u, gen=%s\n", N, a, seed, gen == RANDN_ZIGGURAT ? "ziggurat" : "box-muller");
     printf("[Deterministic] max |d - (a*x + y)| = %.3e,  L1 total error = %.3e\n",
            max_abs_err, l1_err);
     printf("[Statistical]   mean(d)   = %.6e  (expected 0)\n", mean_hat);
     printf("                var(d)    = %.6e  (expected %.6e)\n", var_hat, var_theory);
     printf("                3*SE(mean)= %.6e  => mean should lie within +/- this band\n", 3.0*se_mean);
-    printf("Checks: mean ~ 0 ? %s  |  var ~ a^2+1 ? %s\n",
-           pass_mean? "OK":"NO", pass_var? "OK":"NO");
-
-    free(x); free(y); free(d);
+    printf("                skewness  = %+.3e  (expected 0, 4*SE = %.1e)\n", skew_hat, 4.0*se_skew);
+    printf("                ex.kurt.  = %+.3e  (expected 0, 4*SE = %.1e)\n", kurt_hat, 4.0*se_kurt);
+    printf("Checks: mean ~ 0 ? %s  |  var ~ a^2+1 ? %s  |  skew ~ 0 ? %s  |  ex.kurt ~ 0 ? %s\n",
+           pass_mean? "OK":"NO", pass_var? "OK":"NO", pass_skew? "OK":"NO", pass_kurt? "OK":"NO");
+    printf("[TIME] %s: %.3f s (%.2f ns/sample), data held: %s\n",
+           streaming ? "stream" : "arrays", t1 - t0, 1e9 * (t1 - t0) / (double)N,
+           streaming ? "3 x 16 KB blocks per thread" : "x, y, d (24 bytes x N)");
     return 0;
 }
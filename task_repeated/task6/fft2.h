@@ -0,0 +1,148 @@
+// fft2.h
+// 2D FFT helpers for task6 on top of FFTW.
+//
+// The FFT of a real n0 x n1 matrix is Hermitian, C[r,c] = conj(C[-r,-c])
+// (indices mod n0, n1), so fftw_plan_dft_r2c_2d stores only the columns
+// c = 0 .. n1/2: an n0 x (n1/2+1) "half spectrum". That is half the output
+// memory and about half the flops of the complex (c2c) transform of the
+// same data with zero imaginary part. The missing columns are rebuilt only
+// when asked for:
+//
+//   fft2_nh           n1/2 + 1, the row length of the half spectrum
+//   fft2_half_at      C[r,c] for any (r, c) from the half spectrum
+//   fft2_expand_row   row r of the full n0 x n1 spectrum
+//   fft2_expand       the whole full spectrum (n0*n1 complex, caller's buffer)
+//   fft2_next_smooth  smallest m >= n without prime factors above pmax:
+//                     FFTW is fastest on 2^a 3^b 5^c 7^d, slow on big primes
+//
+// Planning: FFTW_ESTIMATE plans instantly from a heuristic; MEASURE /
+// PATIENT / EXHAUSTIVE time candidate algorithms on this machine, which
+// costs seconds per size but gives a faster plan. fft2_plan_cached keeps
+// the result ("wisdom") in one file per machine and problem,
+//   $FFT2_WISDOM_DIR/fftw-<host>-<kind>-<n0>x<n1>-<fwd|bwd>-<effort>.wisdom
+// (default dir "."), so only the first run pays for planning. A plan made
+// from wisdom alone (FFTW_WISDOM_ONLY) is a cache hit. MEASURE and up
+// overwrite the arrays while planning: plan first, fill afterwards.
+//
+// fft2.h calls gethostname: define _POSIX_C_SOURCE before the includes.
+
+#ifndef FFT2_H
+#define FFT2_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <fftw3.h>
+
+static inline size_t fft2_nh(int n1) { return (size_t)(n1 / 2 + 1); }
+
+static inline int fft2_next_smooth(int n, int pmax) {
+    for (int m = (n < 1) ? 1 : n;; ++m) {
+        int r = m;
+        for (int p = 2; p <= pmax && r > 1; ++p)
+            while (r % p == 0) r /= p;
+        if (r == 1) return m;
+    }
+}
+
+static inline void fft2_half_at(const fftw_complex *half, int n0, int n1, int r, int c,
+                                double *re, double *im) {
+    size_t nh = fft2_nh(n1);
+    if ((size_t)c < nh) {
+        *re = half[(size_t)r * nh + (size_t)c][0];
+        *im = half[(size_t)r * nh + (size_t)c][1];
+    } else {
+        size_t rr = (size_t)((n0 - r) % n0), cc = (size_t)(n1 - c);
+        *re = half[rr * nh + cc][0];
+        *im = -half[rr * nh + cc][1];
+    }
+}
+
+static inline void fft2_expand_row(const fftw_complex *half, int n0, int n1, int r, fftw_complex *row) {
+    size_t nh = fft2_nh(n1);
+    const fftw_complex *h = half + (size_t)r * nh;
+    const fftw_complex *m = half + (size_t)((n0 - r) % n0) * nh;   // mirrored row
+    for (size_t c = 0; c < nh; ++c) {
+        row[c][0] = h[c][0];
+        row[c][1] = h[c][1];
+    }
+    for (size_t c = nh; c < (size_t)n1; ++c) {
+        row[c][0] = m[(size_t)n1 - c][0];
+        row[c][1] = -m[(size_t)n1 - c][1];
+    }
+}
+
+static inline void fft2_expand(const fftw_complex *half, int n0, int n1, fftw_complex *full) {
+    for (int r = 0; r < n0; ++r) fft2_expand_row(half, n0, n1, r, full + (size_t)r * (size_t)n1);
+}
+
+// ---- planner effort and wisdom cache ----
+// "estimate" ... "exhaustive" -> FFTW flag; -1 if unknown
+static inline int fft2_effort(const char *name, unsigned *flags) {
+    static const struct { const char *name; unsigned flags; } e[] = {
+        { "estimate", FFTW_ESTIMATE }, { "measure", FFTW_MEASURE },
+        { "patient", FFTW_PATIENT },   { "exhaustive", FFTW_EXHAUSTIVE },
+    };
+    for (size_t i = 0; i < sizeof e / sizeof e[0]; ++i)
+        if (strcmp(name, e[i].name) == 0) { *flags = e[i].flags; return 0; }
+    return -1;
+}
+
+static inline const char *fft2_effort_name(unsigned flags) {
+    if (flags & FFTW_ESTIMATE) return "estimate";
+    if (flags & FFTW_EXHAUSTIVE) return "exhaustive";
+    if (flags & FFTW_PATIENT) return "patient";
+    return "measure";
+}
+
+static inline void fft2_wisdom_path(char *buf, size_t len, const char *kind, int n0, int n1,
+                                    int sign, unsigned flags) {
+    const char *dir = getenv("FFT2_WISDOM_DIR");
+    char host[64] = "host";
+    if (gethostname(host, sizeof host) != 0) strcpy(host, "host");
+    host[sizeof host - 1] = '\0';
+    snprintf(buf, len, "%s/fftw-%s-%s-%dx%d-%s-%s.wisdom", (dir && *dir) ? dir : ".", host, kind,
+             n0, n1, (sign == FFTW_FORWARD) ? "fwd" : "bwd", fft2_effort_name(flags));
+}
+
+typedef fftw_plan (*fft2_planner)(void *ctx, unsigned flags);
+
+typedef struct {
+    double seconds;    // wall time spent in the planner (incl. wisdom I/O)
+    int from_wisdom;   // 1 = plan rebuilt from the cache file
+    int saved;         // 1 = new wisdom written to the cache file
+} fft2_plan_info;
+
+// mk(ctx, flags) creates the plan; kind/n0/n1/sign only name the cache file.
+static inline fftw_plan fft2_plan_cached(fft2_planner mk, void *ctx, const char *kind, int n0, int n1,
+                                         int sign, unsigned flags, fft2_plan_info *info) {
+    struct timespec t0, t1;
+    fft2_plan_info tmp;
+    if (!info) info = &tmp;
+    info->from_wisdom = 0;
+    info->saved = 0;
+    timespec_get(&t0, TIME_UTC);
+    fftw_plan p;
+    if (flags & FFTW_ESTIMATE) {
+        p = mk(ctx, flags);                  // nothing worth caching
+    } else {
+        char path[512];
+        fft2_wisdom_path(path, sizeof path, kind, n0, n1, sign, flags);
+        fftw_import_wisdom_from_filename(path);
+        p = mk(ctx, flags | FFTW_WISDOM_ONLY);
+        if (p) {
+            info->from_wisdom = 1;
+        } else {
+            p = mk(ctx, flags);
+            if (p) info->saved = fftw_export_wisdom_to_filename(path);
+        }
+    }
+    timespec_get(&t1, TIME_UTC);
+    info->seconds = (double)(t1.tv_sec - t0.tv_sec) + 1e-9 * (double)(t1.tv_nsec - t0.tv_nsec);
+    return p;
+}
+
+#endif // FFT2_H
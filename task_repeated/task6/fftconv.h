@@ -0,0 +1,260 @@
+// fftconv.h
+// 2D convolution and cross-correlation of real images (row-major doubles).
+//
+//   conv_direct_full  O(ih iw kh kw); every kernel tap is an axpy over an
+//                     image row into an output row (vectorizes, stays in L1)
+//   conv_fft_full     both operands zero-padded to P x Q >= the full output,
+//                     P, Q 2^a 3^b 5^c 7^d (conv_good_size), in-place r2c,
+//                     pointwise product, c2r (fft2.h, FFTW)
+//   conv_ola_full     overlap-add: kernel spectrum once at L x L, the image
+//                     cut into (L-kh+1) x (L-kw+1) tiles; each tile is
+//                     convolved by FFT and its L x L result added into the
+//                     output. Wins when the kernel is small against the image.
+//   conv2d            one entry point: full / same / valid output, convolution
+//                     or correlation, method fixed or CONV_AUTO
+//
+// CONV_AUTO evaluates a cost model for the three methods and takes the
+// cheapest: direct = direct_ns * ih iw kh kw, FFT methods = fft_ns * flops
+// (2.5 n log2 n per real transform of n points + 6 per complex product).
+// conv_calibrate measures the two constants on this host.
+//
+// Output sizes (as scipy.signal.convolve2d): full (ih+kh-1) x (iw+kw-1);
+// same ih x iw, centred; valid (ih-kh+1) x (iw-kw+1). Correlation is the
+// convolution with the kernel flipped: full index (i, j) is the shift
+// (i-kh+1, j-kw+1) of the kernel over the image.
+
+#ifndef FFTCONV_H
+#define FFTCONV_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fftw3.h>
+
+#include "../common/bench.h"
+#include "fft2.h"
+
+typedef enum { CONV_FULL, CONV_SAME, CONV_VALID } conv_shape;
+typedef enum { CONV_AUTO = -1, CONV_DIRECT = 0, CONV_FFT = 1, CONV_OLA = 2 } conv_method;
+
+typedef struct {
+    double direct_ns;   // per multiply-add of the direct loop
+    double fft_ns;      // per flop of the FFT path (model flops, see above)
+} conv_model;
+
+// rough values for a ~3 GHz AVX2 core; conv_calibrate replaces them
+static inline conv_model conv_model_default(void) {
+    conv_model m = { 0.25, 0.5 };
+    return m;
+}
+
+// smallest m >= n with no prime factor above 7 (FFTW's fast sizes)
+static inline int conv_good_size(int n) { return fft2_next_smooth(n, 7); }
+
+// ---- direct ----
+static inline void conv_direct_full(const double *img, int ih, int iw, const double *ker, int kh, int kw,
+                                    double *out) {
+    const size_t ow = (size_t)(iw + kw - 1);
+    memset(out, 0, (size_t)(ih + kh - 1) * ow * sizeof(double));
+    for (int i = 0; i < ih; ++i) {
+        const double *x = img + (size_t)i * iw;
+        for (int u = 0; u < kh; ++u) {
+            double *o = out + (size_t)(i + u) * ow;
+            for (int v = 0; v < kw; ++v) {
+                const double k = ker[(size_t)u * kw + v];
+                double *ov = o + v;
+                for (int j = 0; j < iw; ++j) ov[j] += k * x[j];
+            }
+        }
+    }
+}
+
+// ---- FFT, one transform of the whole padded problem ----
+// a, b: P x 2(Q/2+1) padded real buffers; a <- c2r(r2c(a) * r2c(b)) / (P Q)
+static inline void conv_spectral_product(fftw_complex *a, const fftw_complex *b, size_t n, double scale) {
+    for (size_t i = 0; i < n; ++i) {
+        double re = a[i][0] * b[i][0] - a[i][1] * b[i][1];
+        double im = a[i][0] * b[i][1] + a[i][1] * b[i][0];
+        a[i][0] = scale * re;
+        a[i][1] = scale * im;
+    }
+}
+
+// copy an h x w block (source row stride sst) into a zeroed padded buffer
+static inline void conv_load(double *buf, size_t st, size_t rows, const double *src, size_t sst, int h, int w) {
+    memset(buf, 0, rows * st * sizeof(double));
+    for (int i = 0; i < h; ++i) memcpy(buf + (size_t)i * st, src + (size_t)i * sst, (size_t)w * sizeof(double));
+}
+
+static inline int conv_fft_full(const double *img, int ih, int iw, const double *ker, int kh, int kw,
+                                double *out, unsigned flags) {
+    const int oh = ih + kh - 1, ow = iw + kw - 1;
+    const int P = conv_good_size(oh), Q = conv_good_size(ow);
+    const size_t nh = fft2_nh(Q), st = 2 * nh;
+    double *a = fftw_alloc_real((size_t)P * st), *b = fftw_alloc_real((size_t)P * st);
+    if (!a || !b) { fftw_free(a); fftw_free(b); return -1; }
+    fftw_plan fwd = fftw_plan_dft_r2c_2d(P, Q, a, (fftw_complex*) a, flags);
+    fftw_plan inv = fftw_plan_dft_c2r_2d(P, Q, (fftw_complex*) a, a, flags);
+    conv_load(a, st, (size_t)P, img, (size_t)iw, ih, iw);
+    conv_load(b, st, (size_t)P, ker, (size_t)kw, kh, kw);
+    fftw_execute(fwd);
+    fftw_execute_dft_r2c(fwd, b, (fftw_complex*) b);
+    conv_spectral_product((fftw_complex*) a, (const fftw_complex*) b, (size_t)P * nh, 1.0 / ((double)P * Q));
+    fftw_execute(inv);
+    for (int i = 0; i < oh; ++i) memcpy(out + (size_t)i * ow, a + (size_t)i * st, (size_t)ow * sizeof(double));
+    fftw_destroy_plan(fwd);
+    fftw_destroy_plan(inv);
+    fftw_free(a);
+    fftw_free(b);
+    return 0;
+}
+
+// ---- FFT, overlap-add over L x L tiles ----
+static inline int conv_ola_full(const double *img, int ih, int iw, const double *ker, int kh, int kw,
+                                double *out, int L, unsigned flags) {
+    const int oh = ih + kh - 1, ow = iw + kw - 1;
+    const int bh = L - kh + 1, bw = L - kw + 1;   // image rows/cols per tile
+    if (bh < 1 || bw < 1) return -1;
+    const size_t nh = fft2_nh(L), st = 2 * nh;
+    double *t = fftw_alloc_real((size_t)L * st), *k = fftw_alloc_real((size_t)L * st);
+    if (!t || !k) { fftw_free(t); fftw_free(k); return -1; }
+    fftw_plan fwd = fftw_plan_dft_r2c_2d(L, L, t, (fftw_complex*) t, flags);
+    fftw_plan inv = fftw_plan_dft_c2r_2d(L, L, (fftw_complex*) t, t, flags);
+    conv_load(k, st, (size_t)L, ker, (size_t)kw, kh, kw);
+    fftw_execute_dft_r2c(fwd, k, (fftw_complex*) k);
+    memset(out, 0, (size_t)oh * ow * sizeof(double));
+    for (int ti = 0; ti < ih; ti += bh) {
+        const int th = (ih - ti < bh) ? ih - ti : bh;
+        for (int tj = 0; tj < iw; tj += bw) {
+            const int tw = (iw - tj < bw) ? iw - tj : bw;
+            conv_load(t, st, (size_t)L, img + (size_t)ti * iw + tj, (size_t)iw, th, tw);
+            fftw_execute(fwd);
+            conv_spectral_product((fftw_complex*) t, (const fftw_complex*) k, (size_t)L * nh, 1.0 / ((double)L * L));
+            fftw_execute(inv);
+            // the tile's full convolution is (th+kh-1) x (tw+kw-1), overlapping its neighbours
+            for (int i = 0; i < th + kh - 1; ++i) {
+                double *o = out + (size_t)(ti + i) * ow + tj;
+                const double *r = t + (size_t)i * st;
+                for (int j = 0; j < tw + kw - 1; ++j) o[j] += r[j];
+            }
+        }
+    }
+    fftw_destroy_plan(fwd);
+    fftw_destroy_plan(inv);
+    fftw_free(t);
+    fftw_free(k);
+    return 0;
+}
+
+// ---- cost model ----
+static inline double conv_fft_flops(int P, int Q) {   // one real 2D transform
+    double n = (double)P * Q;
+    return 2.5 * n * log2(n);
+}
+
+static inline double conv_cost(const conv_model *m, conv_method meth, int ih, int iw, int kh, int kw, int L) {
+    if (meth == CONV_DIRECT) return m->direct_ns * (double)ih * iw * kh * kw;
+    if (meth == CONV_FFT) {
+        int P = conv_good_size(ih + kh - 1), Q = conv_good_size(iw + kw - 1);
+        return m->fft_ns * (3.0 * conv_fft_flops(P, Q) + 6.0 * P * (double)fft2_nh(Q));
+    }
+    int bh = L - kh + 1, bw = L - kw + 1;
+    if (bh < 1 || bw < 1) return HUGE_VAL;
+    double tiles = (double)((ih + bh - 1) / bh) * (double)((iw + bw - 1) / bw);
+    return m->fft_ns * ((2.0 * tiles + 1.0) * conv_fft_flops(L, L) + 6.0 * tiles * L * (double)fft2_nh(L));
+}
+
+typedef struct {
+    conv_method method;
+    int tile;          // L for CONV_OLA
+    double cost_ns;    // model prediction
+} conv_choice;
+
+// cheapest tile: fast sizes from 2 max(kh, kw) up to the full padded size
+static inline conv_choice conv_choose(const conv_model *m, int ih, int iw, int kh, int kw) {
+    conv_choice c = { CONV_DIRECT, 0, conv_cost(m, CONV_DIRECT, ih, iw, kh, kw, 0) };
+    double f = conv_cost(m, CONV_FFT, ih, iw, kh, kw, 0);
+    if (f < c.cost_ns) { c.method = CONV_FFT; c.cost_ns = f; }
+    int kmax = (kh > kw) ? kh : kw;
+    int full = conv_good_size(((ih > iw) ? ih : iw) + kmax - 1);
+    for (int L = conv_good_size(2 * kmax); L < full; L = conv_good_size(L + 1)) {
+        double o = conv_cost(m, CONV_OLA, ih, iw, kh, kw, L);
+        if (o < c.cost_ns) { c.method = CONV_OLA; c.tile = L; c.cost_ns = o; }
+    }
+    return c;
+}
+
+// ---- entry point ----
+// out must hold the requested shape. Returns the method used, -1 on failure.
+static inline int conv2d(const double *img, int ih, int iw, const double *ker, int kh, int kw, double *out,
+                         conv_shape shape, int correlate, conv_method method, const conv_model *model) {
+    if (shape == CONV_VALID && (ih < kh || iw < kw)) return -1;
+    const int oh = ih + kh - 1, ow = iw + kw - 1;
+    conv_model dm = conv_model_default();
+    conv_choice c = conv_choose(model ? model : &dm, ih, iw, kh, kw);
+    if (method != CONV_AUTO) {
+        c.method = method;
+        if (method == CONV_OLA) {   // best tile for the forced method
+            conv_model only_fft = { HUGE_VAL, model ? model->fft_ns : dm.fft_ns };
+            conv_choice t = conv_choose(&only_fft, ih, iw, kh, kw);
+            c.tile = (t.method == CONV_OLA) ? t.tile : conv_good_size(2 * ((kh > kw) ? kh : kw));
+        }
+    }
+
+    const double *k = ker;
+    double *flip = NULL, *full = out;
+    if (correlate) {
+        flip = malloc((size_t)kh * kw * sizeof(double));
+        if (!flip) return -1;
+        for (size_t i = 0, n = (size_t)kh * kw; i < n; ++i) flip[i] = ker[n - 1 - i];
+        k = flip;
+    }
+    if (shape != CONV_FULL) {
+        full = malloc((size_t)oh * ow * sizeof(double));
+        if (!full) { free(flip); return -1; }
+    }
+
+    int rc = 0;
+    if (c.method == CONV_DIRECT) conv_direct_full(img, ih, iw, k, kh, kw, full);
+    else if (c.method == CONV_FFT) rc = conv_fft_full(img, ih, iw, k, kh, kw, full, FFTW_ESTIMATE);
+    else rc = conv_ola_full(img, ih, iw, k, kh, kw, full, c.tile, FFTW_ESTIMATE);
+
+    if (rc == 0 && shape != CONV_FULL) {
+        int r0 = (shape == CONV_SAME) ? (kh - 1) / 2 : kh - 1, c0 = (shape == CONV_SAME) ? (kw - 1) / 2 : kw - 1;
+        int h = (shape == CONV_SAME) ? ih : ih - kh + 1, w = (shape == CONV_SAME) ? iw : iw - kw + 1;
+        for (int i = 0; i < h; ++i)
+            memcpy(out + (size_t)i * w, full + (size_t)(r0 + i) * ow + c0, (size_t)w * sizeof(double));
+    }
+    if (full != out) free(full);
+    free(flip);
+    return (rc == 0) ? (int)c.method : -1;
+}
+
+// ---- calibration: one direct and one FFT run on a 256 x 256 image ----
+static inline void conv_calibrate(conv_model *m) {
+    const int n = 256, k = 9, reps = 3;
+    double *img = malloc((size_t)n * n * sizeof(double)), *ker = malloc((size_t)k * k * sizeof(double));
+    double *out = malloc((size_t)(n + k - 1) * (n + k - 1) * sizeof(double));
+    *m = conv_model_default();
+    if (!img || !ker || !out) { free(img); free(ker); free(out); return; }
+    for (int i = 0; i < n * n; ++i) img[i] = sin(0.01 * i);
+    for (int i = 0; i < k * k; ++i) ker[i] = cos(0.1 * i);
+    double td = HUGE_VAL, tf = HUGE_VAL;
+    for (int r = 0; r < reps; ++r) {
+        double t0 = bench_now();
+        conv_direct_full(img, n, n, ker, k, k, out);
+        double t1 = bench_now();
+        conv_fft_full(img, n, n, ker, k, k, out, FFTW_ESTIMATE);
+        double t2 = bench_now();
+        if (t1 - t0 < td) td = t1 - t0;
+        if (t2 - t1 < tf) tf = t2 - t1;
+    }
+    conv_model unit = { 1.0, 1.0 };
+    m->direct_ns = 1e9 * td / conv_cost(&unit, CONV_DIRECT, n, n, k, k, 0);
+    m->fft_ns = 1e9 * tf / conv_cost(&unit, CONV_FFT, n, n, k, k, 0);
+    free(img);
+    free(ker);
+    free(out);
+}
+
+#endif // FFTCONV_H
@@ -1,77 +1,472 @@
 // task06_part1.c
 // Part 1: build A (1000x1000 Gaussian mean=1, std=1) and compute C = FFT2(A)
 // Requires: libfftw3-dev
+// Build: gcc -O3 -march=native -fno-math-errno -std=c11 -fopenmp task6.c -o task6 -lfftw3_omp -lfftw3 -lm
+// Run:   ./task6 [seed] [bm|zig] [c2c|r2c] [estimate|measure|patient|exhaustive]
+//        (default seed = time, bm, c2c, estimate; A is Philox stream 0 of
+//        the seed, normals from ../common/randn.h)
+//   c2c: A copied into a complex array (imag = 0), full N x N complex FFT
+//   r2c: FFT of the real A straight into the N x (N/2+1) half spectrum
+//        (fft2.h); the other half is rebuilt by Hermitian symmetry only
+//        where it is read (spot checks, C.npy). Half the memory and flops.
+//   planner effort other than estimate: the plan is cached as FFTW wisdom
+//        (fft2.h, dir $FFT2_WISDOM_DIR or .); later runs skip the planning.
+//
+//        ./task6 batch [frames] [threads] [many|inner|across] [c2c|r2c] [effort] [seed]
+//   Throughput over many N x N frames (default 16 frames, all threads, many,
+//   r2c, estimate); frame f is Philox stream f of the seed.
+//   many:   one fftw_plan_many_dft(_r2c) plan over all frames, FFTW threads
+//   inner:  one-frame plan, FFTW threads inside each transform, frames in turn
+//   across: one-frame single-threaded plan, frames spread over OpenMP threads
+//           (fftw_execute_dft on each frame's arrays; execute is thread-safe)
+//   Reports frames/s and GFLOP/s counted as 5 N^2 log2(N^2) per frame (the
+//   c2c convention, also used for r2c so the two compare by time).
+//
+//        ./task6 inplace [seed] [bm|zig] [effort]
+//   Low-footprint r2c for large N (build with -DN=16384): one padded
+//   N x 2(N/2+1) real buffer, filled row by row straight from the generator
+//   (no separate A), A.npy streamed out of it, transformed in place, then
+//   C.npy streamed out one expanded row at a time. Peak ~8 bytes/element
+//   instead of 16 (r2c) or 40 (c2c). Same A, C and spot checks as above.
+//
+// Output: A.npy (float64, N x N) and C.npy (complex128, full N x N
+// spectrum), written row by row; np.load("C.npy", mmap_mode="r") slices
+// them without reading everything (../common/npy.h). With TASK6_FORMAT=h5
+// they become datasets "A" and "C" (complex as compound {r, i}, as h5py
+// reads it) of task6.h5; build that with
+//   gcc ... -DUSE_HDF5 $(pkg-config --cflags hdf5) ... $(pkg-config --libs hdf5)
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 #include <fftw3.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef USE_HDF5
+#include <hdf5.h>
+#endif
+
+#include "../common/bench.h"
+#include "../common/randn.h"
+#include "../common/npy.h"
+#include "fft2.h"
 
 #ifndef N
 #define N 1000
 #endif
 
-// Box–Muller standard normal (mean 0, std 1)
-static double randn(void) {
-    double u1 = 0.0, u2 = 0.0;
-    // avoid u1 == 0
-    while (u1 <= 1e-12) {
-        u1 = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
-        u2 = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
-    }
-    double r = sqrt(-2.0 * log(u1));
-    double theta = 2.0 * M_PI * u2;
-    return r * cos(theta);
+typedef struct { double *A; fftw_complex *in, *out; } bufs;
+
+static fftw_plan plan_c2c(void *ctx, unsigned flags) {
+    bufs *b = (bufs*) ctx;
+    return fftw_plan_dft_2d(N, N, b->in, b->out, FFTW_FORWARD, flags);
+}
+
+static fftw_plan plan_r2c(void *ctx, unsigned flags) {
+    bufs *b = (bufs*) ctx;
+    return fftw_plan_dft_r2c_2d(N, N, b->A, b->out, flags);
+}
+
+// ---- output: A / C as .npy or HDF5 datasets, appended row by row ----
+typedef struct {
+    FILE *f;
+    int cplx;
+    size_t rows, cols, next;
+#ifdef USE_HDF5
+    hid_t file, ds, type;
+#endif
+} mat_out;
+
+static int out_is_h5(void) {
+    const char *f = getenv("TASK6_FORMAT");
+    return f && strcmp(f, "h5") == 0;
+}
+
+// name "A" (opened first: creates task6.h5) or "C"
+static int mat_open(mat_out *m, const char *name, int cplx, size_t rows, size_t cols) {
+    m->f = NULL; m->cplx = cplx; m->rows = rows; m->cols = cols; m->next = 0;
+    if (out_is_h5()) {
+#ifndef USE_HDF5
+        fprintf(stderr, "Rebuild with -DUSE_HDF5 for TASK6_FORMAT=h5.\n");
+        return -1;
+#else
+        m->file = (name[0] == 'A') ? H5Fcreate("task6.h5", H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)
+                                   : H5Fopen("task6.h5", H5F_ACC_RDWR, H5P_DEFAULT);
+        if (m->file < 0) { fprintf(stderr, "cannot open task6.h5\n"); return -1; }
+        if (cplx) {
+            m->type = H5Tcreate(H5T_COMPOUND, 2 * sizeof(double));
+            H5Tinsert(m->type, "r", 0, H5T_NATIVE_DOUBLE);
+            H5Tinsert(m->type, "i", sizeof(double), H5T_NATIVE_DOUBLE);
+        } else {
+            m->type = H5Tcopy(H5T_NATIVE_DOUBLE);
+        }
+        hsize_t dims[2] = { rows, cols };
+        hid_t space = H5Screate_simple(2, dims, NULL);
+        m->ds = H5Dcreate2(m->file, name, m->type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        H5Sclose(space);
+        if (m->ds < 0) { fprintf(stderr, "H5Dcreate2 failed: dataset '%s'\n", name); return -1; }
+        return 0;
+#endif
+    }
+    char path[64];
+    snprintf(path, sizeof path, "%s.npy", name);
+    m->f = fopen(path, "wb");
+    if (!m->f || npy_write_header(m->f, cplx ? "c16" : "f8", rows, cols) != 0) {
+        perror(path);
+        if (m->f) fclose(m->f);
+        m->f = NULL;
+        return -1;
+    }
+    return 0;
 }
 
-int main(void) {
-    srand((unsigned)time(NULL));
+static void mat_rows(mat_out *m, const void *data, size_t nrows) {
+    if (m->f) {
+        fwrite(data, m->cplx ? sizeof(fftw_complex) : sizeof(double), nrows * m->cols, m->f);
+    }
+#ifdef USE_HDF5
+    else {
+        hsize_t start[2] = { m->next, 0 }, count[2] = { nrows, m->cols };
+        hid_t fs = H5Dget_space(m->ds), ms = H5Screate_simple(2, count, NULL);
+        H5Sselect_hyperslab(fs, H5S_SELECT_SET, start, NULL, count, NULL);
+        H5Dwrite(m->ds, m->type, ms, fs, H5P_DEFAULT, data);
+        H5Sclose(ms);
+        H5Sclose(fs);
+    }
+#endif
+    m->next += nrows;
+}
+
+static void mat_close(mat_out *m) {
+    if (m->f) { fclose(m->f); m->f = NULL; return; }
+#ifdef USE_HDF5
+    H5Dclose(m->ds);
+    H5Tclose(m->type);
+    H5Fclose(m->file);
+#endif
+}
+
+// read the .npy headers back: what a notebook will see
+static void check_outputs(void) {
+    if (out_is_h5()) return;
+    const char *name[2] = { "A.npy", "C.npy" }, *want[2] = { "f8", "c16" };
+    int ok = 1;
+    char dt[2][8] = { "", "" };
+    size_t r[2] = { 0, 0 }, c[2] = { 0, 0 };
+    for (int k = 0; k < 2; ++k) {
+        FILE *f = fopen(name[k], "rb");
+        long off = f ? npy_read_header(f, dt[k], &r[k], &c[k]) : -1;
+        if (f) {
+            fseek(f, 0, SEEK_END);
+            long size = ftell(f);
+            ok = ok && off > 0 && strcmp(dt[k], want[k]) == 0 && r[k] == N && c[k] == N &&
+                 (size_t)(size - off) == (size_t)N * N * (k ? sizeof(fftw_complex) : sizeof(double));
+            fclose(f);
+        } else {
+            ok = 0;
+        }
+    }
+    printf("[CHECK] A.npy %s %zux%zu, C.npy %s %zux%zu (header + raw data, mmap-able)  %s\n",
+           dt[0], r[0], c[0], dt[1], r[1], c[1], ok ? "OK" : "FAIL");
+}
+
+// ---- batch mode ----
+enum { BATCH_MANY, BATCH_INNER, BATCH_ACROSS };
+
+typedef struct {
+    int howmany, r2c;
+    double *A; fftw_complex *in, *out;
+    size_t dist_in, dist_out;   // elements from one frame to the next
+} batch_bufs;
+
+static fftw_plan plan_batch(void *ctx, unsigned flags) {
+    batch_bufs *b = (batch_bufs*) ctx;
+    const int n[2] = { N, N };
+    if (b->r2c)
+        return fftw_plan_many_dft_r2c(2, n, b->howmany, b->A, NULL, 1, (int)b->dist_in,
+                                      b->out, NULL, 1, (int)b->dist_out, flags);
+    return fftw_plan_many_dft(2, n, b->howmany, b->in, NULL, 1, (int)b->dist_in,
+                              b->out, NULL, 1, (int)b->dist_out, FFTW_FORWARD, flags);
+}
+
+static void batch_execute(fftw_plan p, const batch_bufs *b, int frames, int mode, int threads) {
+    if (mode == BATCH_MANY) { fftw_execute(p); return; }
+    (void)threads;
+    #pragma omp parallel for num_threads(mode == BATCH_INNER ? 1 : threads) schedule(dynamic)
+    for (int f = 0; f < frames; ++f) {
+        if (b->r2c) fftw_execute_dft_r2c(p, b->A + (size_t)f * b->dist_in, b->out + (size_t)f * b->dist_out);
+        else fftw_execute_dft(p, b->in + (size_t)f * b->dist_in, b->out + (size_t)f * b->dist_out);
+    }
+}
+
+static int run_batch(int argc, char **argv) {
+    int frames = (argc > 2) ? atoi(argv[2]) : 16;
+#ifdef _OPENMP
+    int threads = (argc > 3) ? atoi(argv[3]) : omp_get_max_threads();
+#else
+    int threads = (argc > 3) ? atoi(argv[3]) : 1;
+#endif
+    const char *mname = (argc > 4) ? argv[4] : "many";
+    int mode = !strcmp(mname, "inner") ? BATCH_INNER : !strcmp(mname, "across") ? BATCH_ACROSS : BATCH_MANY;
+    int r2c = !(argc > 5 && strcmp(argv[5], "c2c") == 0);
+    unsigned effort = FFTW_ESTIMATE;
+    if (argc > 6 && fft2_effort(argv[6], &effort) != 0) {
+        fprintf(stderr, "Unknown planner effort '%s' (estimate|measure|patient|exhaustive)\n", argv[6]);
+        return 1;
+    }
+    unsigned long long seed = (argc > 7) ? strtoull(argv[7], NULL, 10) : (unsigned long long)time(NULL);
+    if (frames < 1 || threads < 1 || (mode == BATCH_MANY && strcmp(mname, "many"))) {
+        fprintf(stderr, "Usage: %s batch [frames] [threads] [many|inner|across] [c2c|r2c] [effort] [seed]\n", argv[0]);
+        return 1;
+    }
+    if (!fftw_init_threads()) { fprintf(stderr, "fftw_init_threads failed\n"); return 1; }
+
+    // frames start on 64-byte boundaries so the one-frame plan fits all of them
+    const size_t nn = (size_t)N * N, nh = fft2_nh(N);
+    batch_bufs b;
+    b.r2c = r2c;
+    b.dist_in = r2c ? (nn + 7) / 8 * 8 : (nn + 3) / 4 * 4;
+    b.dist_out = r2c ? ((size_t)N * nh + 3) / 4 * 4 : b.dist_in;
+    b.A = r2c ? fftw_alloc_real(b.dist_in * (size_t)frames) : NULL;
+    b.in = r2c ? NULL : fftw_alloc_complex(b.dist_in * (size_t)frames);
+    b.out = fftw_alloc_complex(b.dist_out * (size_t)frames);
+    if ((r2c ? !b.A : !b.in) || !b.out) { perror("fftw_malloc"); return 1; }
 
-    // Allocate arrays
-    double *A = (double*) malloc((size_t)N * N * sizeof(double));
+    b.howmany = (mode == BATCH_MANY) ? frames : 1;
+    fftw_plan_with_nthreads(mode == BATCH_ACROSS ? 1 : threads);
+    char kind[64];
+    snprintf(kind, sizeof kind, "%s-%s%d-t%d", r2c ? "r2c" : "c2c", mname, b.howmany,
+             mode == BATCH_ACROSS ? 1 : threads);
+    fft2_plan_info pi;
+    fftw_plan plan = fft2_plan_cached(plan_batch, &b, kind, N, N, FFTW_FORWARD, effort, &pi);
+    if (!plan) { fprintf(stderr, "FFTW plan creation failed\n"); return 1; }
+
+    // Fill frames (not timed) and keep each frame's sum = its C[0,0]
+    randn_method gen = RANDN_BOXMULLER;
+    double *dc = (double*) malloc((size_t)frames * sizeof(double));
+    if (!dc) { perror("malloc"); return 1; }
+    #pragma omp parallel for schedule(dynamic)
+    for (int f = 0; f < frames; ++f) {
+        double row[N], s = 0.0;
+        for (int r = 0; r < N; ++r) {
+            randn_fill(gen, seed, (uint32_t)f, (uint64_t)r * N, N, 1.0, 1.0, row);
+            for (int c = 0; c < N; ++c) {
+                s += row[c];
+                if (r2c) {
+                    b.A[(size_t)f * b.dist_in + (size_t)r * N + c] = row[c];
+                } else {
+                    b.in[(size_t)f * b.dist_in + (size_t)r * N + c][0] = row[c];
+                    b.in[(size_t)f * b.dist_in + (size_t)r * N + c][1] = 0.0;
+                }
+            }
+        }
+        dc[f] = s;
+    }
+
+    // One warm-up pass, then timed repetitions
+    const int reps = 3;
+    batch_execute(plan, &b, frames, mode, threads);
+    double best = 1e300, total = 0.0;
+    for (int k = 0; k < reps; ++k) {
+        double t0 = bench_now();
+        batch_execute(plan, &b, frames, mode, threads);
+        double t = bench_now() - t0;
+        total += t;
+        if (t < best) best = t;
+    }
+
+    double maxrel = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        double d = fabs(b.out[(size_t)f * b.dist_out][0] - dc[f]) / (double)nn;
+        if (d > maxrel) maxrel = d;
+    }
+    printf("C[0,0] of frame 0 = %.6e + %.6ei\n", b.out[0][0], b.out[0][1]);
+    printf("[CHECK] C[0,0] = sum(A) in all %d frames: max |diff|/N^2 = %.3e  %s\n", frames, maxrel,
+           (maxrel < 1e-12) ? "OK" : "FAIL");
+    double flop = 5.0 * (double)nn * log2((double)nn) * frames;
+    printf("[TIME] plan (%s): %.6f s%s\n", fft2_effort_name(effort), pi.seconds,
+           pi.from_wisdom ? " | from wisdom cache" : (pi.saved ? " | wisdom saved" : ""));
+    printf("[TIME] batch %s %s: %d frames of %dx%d | %d threads | best %.6f s, mean %.6f s (%d reps) | "
+           "%.1f frames/s | %.2f GFLOP/s\n", mname, r2c ? "r2c" : "c2c", frames, N, N, threads, best,
+           total / reps, reps, frames / best, flop / best * 1e-9);
+
+    fftw_destroy_plan(plan);
+    fftw_free(b.A);
+    fftw_free(b.in);
+    fftw_free(b.out);
+    free(dc);
+    fftw_cleanup_threads();
+    return (maxrel < 1e-12) ? 0 : 1;
+}
+
+// ---- in-place mode ----
+static fftw_plan plan_inplace(void *ctx, unsigned flags) {
+    double *buf = (double*) ctx;
+    return fftw_plan_dft_r2c_2d(N, N, buf, (fftw_complex*) buf, flags);
+}
+
+static int run_inplace(int argc, char **argv) {
+    unsigned long long seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : (unsigned long long)time(NULL);
+    randn_method gen = (argc > 3 && argv[3][0] == 'z') ? RANDN_ZIGGURAT : RANDN_BOXMULLER;
+    unsigned effort = FFTW_ESTIMATE;
+    if (argc > 4 && fft2_effort(argv[4], &effort) != 0) {
+        fprintf(stderr, "Unknown planner effort '%s' (estimate|measure|patient|exhaustive)\n", argv[4]);
+        return 1;
+    }
+    // row r: N reals of A, then 2 doubles of padding; after the transform
+    // the same 2(N/2+1) doubles hold row r of the half spectrum
+    const size_t nh = fft2_nh(N), stride = 2 * nh;
+    double *buf = fftw_alloc_real((size_t)N * stride);
+    fftw_complex *row = fftw_alloc_complex(N);
+    if (!buf || !row) { perror("fftw_malloc"); return 1; }
+
+    fft2_plan_info pi;
+    fftw_plan plan = fft2_plan_cached(plan_inplace, buf, "r2c-inplace", N, N, FFTW_FORWARD, effort, &pi);
+    if (!plan) { fprintf(stderr, "FFTW plan creation failed\n"); return 1; }
+
+    double t0 = bench_now();
+    mat_out fa;
+    int have_a = (mat_open(&fa, "A", 0, N, N) == 0);
+    for (int r = 0; r < N; ++r) {
+        double *a = buf + (size_t)r * stride;
+        randn_fill(gen, seed, 0, (uint64_t)r * N, N, 1.0, 1.0, a);   // element r*N + c of A
+        if (have_a) mat_rows(&fa, a, 1);
+    }
+    if (have_a) mat_close(&fa);
+    double t_fill = bench_now() - t0;
+
+    t0 = bench_now();
+    fftw_execute(plan);
+    double t_exec = bench_now() - t0;
+
+    const fftw_complex *C = (const fftw_complex*) buf;
+    const int spot[3][2] = { {0, 0}, {0, 1}, {1, N - 1} };
+    for (int k = 0; k < 3; ++k) {
+        double re, im;
+        fft2_half_at(C, N, N, spot[k][0], spot[k][1], &re, &im);
+        printf("C[%d,%d] = %.6e + %.6ei\n", spot[k][0], spot[k][1], re, im);
+    }
+
+    t0 = bench_now();
+    mat_out fc;
+    if (have_a && mat_open(&fc, "C", 1, N, N) == 0) {
+        for (int r = 0; r < N; ++r) {
+            fft2_expand_row(C, N, N, r, row);
+            mat_rows(&fc, row, 1);
+        }
+        mat_close(&fc);
+        check_outputs();
+    }
+    double t_write = bench_now() - t0;
+
+    size_t bytes = (size_t)N * stride * sizeof(double) + (size_t)N * sizeof(fftw_complex);
+    printf("[TIME] plan (%s): %.6f s%s\n", fft2_effort_name(effort), pi.seconds,
+           pi.from_wisdom ? " | from wisdom cache" : (pi.saved ? " | wisdom saved" : ""));
+    printf("[TIME] fill + A out: %.6f s | r2c in place: %.6f s | C out: %.6f s\n", t_fill, t_exec, t_write);
+    printf("[MEM] %dx%d: buffers %.1f MB = %.2f bytes/element\n", N, N, (double)bytes / 1e6,
+           (double)bytes / ((double)N * N));
+
+    fftw_destroy_plan(plan);
+    fftw_free(buf);
+    fftw_free(row);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) return run_batch(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "inplace") == 0) return run_inplace(argc, argv);
+    unsigned long long seed = (argc > 1) ? strtoull(argv[1], NULL, 10) : (unsigned long long)time(NULL);
+    randn_method gen = (argc > 2 && argv[2][0] == 'z') ? RANDN_ZIGGURAT : RANDN_BOXMULLER;
+    int r2c = (argc > 3 && strcmp(argv[3], "r2c") == 0);
+    unsigned effort = FFTW_ESTIMATE;
+    if (argc > 4 && fft2_effort(argv[4], &effort) != 0) {
+        fprintf(stderr, "Unknown planner effort '%s' (estimate|measure|patient|exhaustive)\n", argv[4]);
+        return 1;
+    }
+    const size_t nn = (size_t)N * N;
+    const size_t nout = r2c ? (size_t)N * fft2_nh(N) : nn;
+
+    // Allocate arrays (A is the r2c input itself: FFTW preserves the input
+    // of an out-of-place r2c transform)
+    double *A = r2c ? fftw_alloc_real(nn) : (double*) malloc(nn * sizeof(double));
     if (!A) { perror("malloc A"); return 1; }
 
     // FFTW complex input/output
-    fftw_complex *in  = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * (size_t)N * N);
-    fftw_complex *out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * (size_t)N * N);
-    if (!in || !out) { perror("fftw_malloc"); return 1; }
+    fftw_complex *in  = r2c ? NULL : (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nn);
+    fftw_complex *out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nout);
+    if ((!r2c && !in) || !out) { perror("fftw_malloc"); return 1; }
+
+    // Plan 2D FFT (unnormalized forward transform) before filling: the
+    // measuring planner scribbles over the arrays
+    bufs b = { A, in, out };
+    fft2_plan_info pi;
+    fftw_plan plan = fft2_plan_cached(r2c ? plan_r2c : plan_c2c, &b, r2c ? "r2c" : "c2c", N, N,
+                                      FFTW_FORWARD, effort, &pi);
+    if (!plan) { fprintf(stderr, "FFTW plan creation failed\n"); return 1; }
 
     // Fill A with N(1,1) and copy to complex input (imag = 0)
-    for (size_t i = 0; i < (size_t)N * N; ++i) {
-        double val = 1.0 + randn();     // mean 1, std 1
-        A[i] = val;
-        in[i][0] = val;                 // real
+    randn_fill(gen, seed, 0, 0, nn, 1.0, 1.0, A);   // mean 1, std 1
+    for (size_t i = 0; !r2c && i < nn; ++i) {
+        in[i][0] = A[i];                // real
         in[i][1] = 0.0;                 // imag
     }
 
-    // Plan and execute 2D C2C FFT (unnormalized forward transform)
-    fftw_plan plan = fftw_plan_dft_2d(N, N, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-    if (!plan) { fprintf(stderr, "FFTW plan creation failed\n"); return 1; }
+    // Execute
+    double t0 = bench_now();
     fftw_execute(plan);
+    double t_exec = bench_now() - t0;
 
-    // Simple sanity print: C[0,0] (DC component) and a neighbor
+    // Simple sanity print: C[0,0] (DC component) and neighbors; C[1,N-1]
+    // is outside the stored half in r2c mode (rebuilt as conj(C[N-1,1]))
     // Note: row-major index (r,c) -> r*N + c
-    size_t idx00 = 0;
-    size_t idx01 = 1;
-
-    printf("C[0,0] = %.6e + %.6ei\n", out[idx00][0], out[idx00][1]);
-    printf("C[0,1] = %.6e + %.6ei\n", out[idx01][0], out[idx01][1]);
-
-    // (Optional) Save A and C to binary for later steps
-    FILE *fa = fopen("A.bin", "wb");
-    if (fa) { fwrite(A, sizeof(double), (size_t)N * N, fa); fclose(fa); }
+    const int spot[3][2] = { {0, 0}, {0, 1}, {1, N - 1} };
+    for (int k = 0; k < 3; ++k) {
+        int r = spot[k][0], c = spot[k][1];
+        double re, im;
+        if (r2c) {
+            fft2_half_at(out, N, N, r, c, &re, &im);
+        } else {
+            re = out[(size_t)r * N + c][0];
+            im = out[(size_t)r * N + c][1];
+        }
+        printf("C[%d,%d] = %.6e + %.6ei\n", r, c, re, im);
+    }
+    size_t bytes = nn * sizeof(double) + (in ? nn * sizeof(fftw_complex) : 0) + nout * sizeof(fftw_complex);
+    printf("[TIME] plan (%s): %.6f s%s\n", fft2_effort_name(effort), pi.seconds,
+           pi.from_wisdom ? " | from wisdom cache" : (pi.saved ? " | wisdom saved" : ""));
+    printf("[TIME] %s: %.6f s | buffers %.1f MB\n", r2c ? "r2c" : "c2c", t_exec, (double)bytes / 1e6);
 
-    FILE *fc = fopen("C.bin", "wb");
-    if (fc) {
-        fwrite(out, sizeof(fftw_complex), (size_t)N * N, fc);
-        fclose(fc);
+    // (Optional) Save A and C for later steps; C is always the full N x N
+    // spectrum, expanded row by row in r2c mode
+    mat_out fa, fc;
+    if (mat_open(&fa, "A", 0, N, N) == 0) {
+        mat_rows(&fa, A, N);
+        mat_close(&fa);
+        if (mat_open(&fc, "C", 1, N, N) == 0) {
+            if (r2c) {
+                fftw_complex *row = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * N);
+                for (int r = 0; row && r < N; ++r) {
+                    fft2_expand_row(out, N, N, r, row);
+                    mat_rows(&fc, row, 1);
+                }
+                fftw_free(row);
+            } else {
+                mat_rows(&fc, out, N);
+            }
+            mat_close(&fc);
+            check_outputs();
+        }
     }
 
     // Cleanup
     fftw_destroy_plan(plan);
+    if (r2c) fftw_free(A); else free(A);
     fftw_free(in);
     fftw_free(out);
-    free(A);
 
     return 0;
 }
@@ -0,0 +1,197 @@
+// task6_bench.c
+// FFT benchmark for choosing the task6 transform: 2D forward FFTs of N x N
+// data over a sweep of
+//   sizes (list), c2c vs r2c, out-of-place vs in-place, FFTW_ESTIMATE vs
+//   FFTW_MEASURE, FFTW thread counts (list)
+// with warm-up executions and timed repetitions (../common/bench.h stats).
+// Reports plan time, median/min execution time, GFLOP/s (5 N^2 log2(N^2)
+// per transform, the c2c convention for both kinds, so GFLOP/s compare as
+// inverse time) and buffer memory; writes <prefix>.csv.
+// Then, for each size in the list, times the nearest fast sizes >= N
+// (2^a 3^b 5^c, 2^a..7^d, next power of 2) and recommends the quickest.
+// Requires: libfftw3-dev
+// Build: gcc -O3 -march=native -std=c11 -fopenmp task6_bench.c -o task6_bench -lfftw3_omp -lfftw3 -lm
+// Run:   ./task6_bench [sizes] [threads] [reps] [out_prefix]
+//        (default 1000,1008,1024  1,<max>  5  task6_bench)
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fftw3.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../common/bench.h"
+#include "../common/cbrng.h"
+#include "fft2.h"
+
+#define WARMUP 2
+
+typedef struct {
+    int n, r2c, inplace, threads;
+    unsigned effort;
+} fft_case;
+
+typedef struct {
+    fft_case c;
+    double plan_s, gflops, mbytes;
+    bench_stats t;
+} fft_result;
+
+// bytes of input (+ output if separate) for one transform
+static void case_bytes(const fft_case *c, size_t *in_b, size_t *out_b) {
+    size_t n = (size_t)c->n, nh = fft2_nh(c->n);
+    if (!c->r2c) {
+        *in_b = n * n * sizeof(fftw_complex);
+        *out_b = c->inplace ? 0 : *in_b;
+    } else if (c->inplace) {
+        *in_b = n * 2 * nh * sizeof(double);   // padded rows
+        *out_b = 0;
+    } else {
+        *in_b = n * n * sizeof(double);
+        *out_b = n * nh * sizeof(fftw_complex);
+    }
+}
+
+static int run_case(const fft_case *c, int reps, fft_result *res) {
+    size_t in_b, out_b;
+    case_bytes(c, &in_b, &out_b);
+    void *in = fftw_malloc(in_b), *out = c->inplace ? in : fftw_malloc(out_b);
+    if (!in || !out) { fftw_free(in); if (!c->inplace) fftw_free(out); return -1; }
+
+    fftw_plan_with_nthreads(c->threads);
+    double t0 = bench_now();
+    fftw_plan p = c->r2c ? fftw_plan_dft_r2c_2d(c->n, c->n, (double*) in, (fftw_complex*) out, c->effort)
+                         : fftw_plan_dft_2d(c->n, c->n, (fftw_complex*) in, (fftw_complex*) out,
+                                            FFTW_FORWARD, c->effort);
+    res->plan_s = bench_now() - t0;
+    if (!p) { fftw_free(in); if (!c->inplace) fftw_free(out); return -1; }
+
+    // uniform data after planning (MEASURE overwrites the arrays); the
+    // padding of in-place r2c rows is filled too, it is never read
+    cbrng_fill_uniform(7, 0, 0, in_b / sizeof(double), (double*) in);
+
+    double *t = (double*) malloc((size_t)reps * sizeof(double));
+    if (!t) { fftw_destroy_plan(p); fftw_free(in); if (!c->inplace) fftw_free(out); return -1; }
+    for (int w = 0; w < WARMUP; ++w) fftw_execute(p);
+    for (int r = 0; r < reps; ++r) {
+        t0 = bench_now();
+        fftw_execute(p);
+        t[r] = bench_now() - t0;
+    }
+    bench_stats_compute(t, reps, &res->t);
+    double nn = (double)c->n * c->n;
+    res->c = *c;
+    res->gflops = 5.0 * nn * log2(nn) / res->t.median * 1e-9;
+    res->mbytes = (double)(in_b + out_b) / 1e6;
+
+    free(t);
+    fftw_destroy_plan(p);
+    fftw_free(in);
+    if (!c->inplace) fftw_free(out);
+    return 0;
+}
+
+static void print_header(void) {
+    printf("%6s %4s %5s %9s %4s %10s %11s %11s %9s %9s\n", "N", "kind", "place", "effort", "thr",
+           "plan[s]", "median[s]", "min[s]", "GFLOP/s", "mem[MB]");
+}
+
+static void print_result(const fft_result *r) {
+    printf("%6d %4s %5s %9s %4d %10.4f %11.6f %11.6f %9.2f %9.1f\n", r->c.n, r->c.r2c ? "r2c" : "c2c",
+           r->c.inplace ? "in" : "out", fft2_effort_name(r->c.effort), r->c.threads, r->plan_s,
+           r->t.median, r->t.min, r->gflops, r->mbytes);
+}
+
+static int write_csv(const char *path, const fft_result *rows, int nrows) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) { perror(path); return -1; }
+    fprintf(fp, "n,kind,place,effort,threads,reps,plan_s,median_s,min_s,max_s,mean_s,stddev_s,gflops,mem_mb\n");
+    for (int i = 0; i < nrows; ++i) {
+        const fft_result *r = &rows[i];
+        fprintf(fp, "%d,%s,%s,%s,%d,%d,%.6e,%.9e,%.9e,%.9e,%.9e,%.9e,%.4f,%.3f\n", r->c.n,
+                r->c.r2c ? "r2c" : "c2c", r->c.inplace ? "in" : "out", fft2_effort_name(r->c.effort),
+                r->c.threads, r->t.n, r->plan_s, r->t.median, r->t.min, r->t.max, r->t.mean, r->t.stddev,
+                r->gflops, r->mbytes);
+    }
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *sizes = (argc > 1) ? argv[1] : "1000,1008,1024";
+#ifdef _OPENMP
+    char tdef[32];
+    snprintf(tdef, sizeof tdef, (omp_get_max_threads() > 1) ? "1,%d" : "%d", omp_get_max_threads());
+    const char *threads = (argc > 2) ? argv[2] : tdef;
+#else
+    const char *threads = (argc > 2) ? argv[2] : "1";
+#endif
+    int reps = (argc > 3) ? atoi(argv[3]) : 5;
+    const char *prefix = (argc > 4) ? argv[4] : "task6_bench";
+    if (reps < 1) reps = 1;
+
+    size_t nlist[32], tlist[16];
+    int nsizes = bench_parse_sizes(sizes, nlist, 32), nthreads = bench_parse_sizes(threads, tlist, 16);
+    if (nsizes == 0 || nthreads == 0) {
+        fprintf(stderr, "Usage: %s [sizes e.g. 1000,1024] [threads e.g. 1,4] [reps] [out_prefix]\n", argv[0]);
+        return 1;
+    }
+    if (!fftw_init_threads()) { fprintf(stderr, "fftw_init_threads failed\n"); return 1; }
+
+    const unsigned efforts[2] = { FFTW_ESTIMATE, FFTW_MEASURE };
+    int maxrows = nsizes * nthreads * 8;
+    fft_result *rows = (fft_result*) calloc((size_t)maxrows, sizeof(fft_result));
+    if (!rows) { perror("calloc"); return 1; }
+    int nrows = 0;
+
+    printf("2D forward FFT, %d warm-up + %d timed executions per point\n", WARMUP, reps);
+    print_header();
+    for (int si = 0; si < nsizes; ++si)
+        for (int r2c = 0; r2c < 2; ++r2c)
+            for (int ip = 0; ip < 2; ++ip)
+                for (int e = 0; e < 2; ++e)
+                    for (int ti = 0; ti < nthreads; ++ti) {
+                        fft_case c = { (int)nlist[si], r2c, ip, (int)tlist[ti], efforts[e] };
+                        if (run_case(&c, reps, &rows[nrows]) != 0) {
+                            fprintf(stderr, "N=%d: allocation or planning failed\n", c.n);
+                            continue;
+                        }
+                        print_result(&rows[nrows++]);
+                    }
+
+    char path[512];
+    snprintf(path, sizeof path, "%s.csv", prefix);
+    if (write_csv(path, rows, nrows) == 0) printf("Wrote %s\n", path);
+
+    // Nearest fast sizes: r2c out-of-place, MEASURE, first thread count
+    printf("\nFast size recommendation (r2c, out-of-place, measure, %d thread(s)):\n", (int)tlist[0]);
+    for (int si = 0; si < nsizes; ++si) {
+        int n = (int)nlist[si], cand[4], nc = 0, p2 = 1;
+        while (p2 < n) p2 *= 2;
+        const int opts[4] = { n, fft2_next_smooth(n, 5), fft2_next_smooth(n, 7), p2 };
+        for (int k = 0; k < 4; ++k) {
+            int dup = 0;
+            for (int j = 0; j < nc; ++j) dup |= (cand[j] == opts[k]);
+            if (!dup) cand[nc++] = opts[k];
+        }
+        int best = -1;
+        double best_t = HUGE_VAL;
+        printf("  N = %d:", n);
+        for (int k = 0; k < nc; ++k) {
+            fft_case c = { cand[k], 1, 0, (int)tlist[0], FFTW_MEASURE };
+            fft_result r;
+            if (run_case(&c, reps, &r) != 0) continue;
+            printf("  %d -> %.6f s", cand[k], r.t.median);
+            if (r.t.median < best_t) { best_t = r.t.median; best = cand[k]; }
+        }
+        if (best == n) printf("  => keep %d\n", n);
+        else printf("  => pad to %d\n", best);
+    }
+
+    free(rows);
+    fftw_cleanup_threads();
+    return 0;
+}
@@ -0,0 +1,306 @@
+// task6_mpi.c
+// Distributed C = FFT2(A) for matrices larger than one node: A (n x n,
+// N(1,1), Philox stream 0 of the seed: the same A as task6.c) is cut into
+// slabs of rows, one slab per rank, and each rank generates only its rows.
+//
+// Build:  mpicc -O3 -march=native -fno-math-errno -std=c11 task6_mpi.c -o task6_mpi -lfftw3 -lm
+//   with FFTW-MPI:  add -DUSE_FFTW_MPI ... -lfftw3_mpi
+// Run:    mpirun -np P ./task6_mpi [builtin|fftw] [n] [seed] [bm|zig] [effort]
+//         (default builtin, n = 1000, seed = time, bm, estimate)
+//
+//   builtin : r2c along the local rows (1D, batched), global transpose with
+//             MPI_Alltoallv, then c2c along the n/2+1 half-spectrum columns,
+//             each rank owning a block of columns. Per-phase timings.
+//             Two slab-sized buffers take turns (rows -> send -> receive ->
+//             columns), so a rank holds about 2x its share of the spectrum.
+//             Alltoallv counts are ints before MPI-4: with an MPI-3 library
+//             every block must stay below 2^31 elements (else a message
+//             asks for more ranks); MPI-4 uses MPI_Alltoallv_c.
+//   fftw    : fftw_mpi_plan_dft_r2c_2d on the same slabs (needs USE_FFTW_MPI);
+//             one timing, FFTW does its transposes internally.
+// Both leave the result transposed (FFTW_MPI_TRANSPOSED_OUT layout): rank q
+// holds columns [c0, c0+nc) of the half spectrum, column c as n contiguous
+// values C[0..n-1, c]. No final transpose back is needed for spot checks or
+// for anything that works column by column.
+//
+// Checks: C[0,0], C[0,1], C[1,n-1] (same lines as task6.c) and Parseval,
+// sum |C|^2 = n^2 sum A^2, over the whole distributed spectrum.
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <mpi.h>
+#include <fftw3.h>
+#ifdef USE_FFTW_MPI
+#include <fftw3-mpi.h>
+#endif
+
+#include "../common/randn.h"
+#include "fft2.h"
+
+enum { PH_GEN, PH_ROWFFT, PH_PACK, PH_ALLTOALL, PH_UNPACK, PH_COLFFT, PH_TOTAL, PH_COUNT };
+static const char *ph_name[PH_COUNT] = { "generate", "row r2c FFTs", "pack", "MPI_Alltoallv",
+                                         "unpack", "column FFTs", "total" };
+
+// block distribution of m items over P ranks: rank p owns [m*p/P, m*(p+1)/P)
+static inline int blk_lo(int m, int p, int P) { return (int)((long long)m * p / P); }
+static inline int blk_n(int m, int p, int P) { return blk_lo(m, p + 1, P) - blk_lo(m, p, P); }
+
+// Alltoallv count / displacement types: 64-bit with the MPI-4 "_c" call
+#if MPI_VERSION >= 4
+typedef MPI_Count a2a_count;
+typedef MPI_Aint  a2a_displ;
+#else
+typedef int a2a_count;
+typedef int a2a_displ;
+#endif
+
+// Transposed column slab: cols[(c - c0) * n + r] = C[r, c] for c in [c0, c0 + nc).
+// Fills the spot values (owner only, 0 elsewhere) and the local Parseval sum.
+static void local_checks(const fftw_complex *cols, int n, int c0, int nc, double spot[6], double *energy) {
+    const int want[3][2] = { {0, 0}, {0, 1}, {1, n - 1} };
+    for (int k = 0; k < 3; ++k) {
+        int r = want[k][0], c = want[k][1], sgn = 1;
+        if (c > n / 2) { r = (n - r) % n; c = n - c; sgn = -1; }   // Hermitian mirror
+        spot[2 * k] = spot[2 * k + 1] = 0.0;
+        if (c >= c0 && c < c0 + nc) {
+            spot[2 * k] = cols[(size_t)(c - c0) * n + r][0];
+            spot[2 * k + 1] = sgn * cols[(size_t)(c - c0) * n + r][1];
+        }
+    }
+    // columns 1 .. (n-1)/2 stand for themselves and their mirror image
+    double e = 0.0;
+    for (int j = 0; j < nc; ++j) {
+        int c = c0 + j;
+        double w = (c == 0 || 2 * c == n) ? 1.0 : 2.0, s = 0.0;
+        const fftw_complex *col = cols + (size_t)j * n;
+        for (int r = 0; r < n; ++r) s += col[r][0] * col[r][0] + col[r][1] * col[r][1];
+        e += w * s;
+    }
+    *energy = e;
+}
+
+// Slab decomposition by hand: rows -> r2c -> Alltoallv transpose -> c2c on columns.
+// Returns NULL on every rank if the counts do not fit the MPI call.
+static fftw_complex *fft2_builtin(int n, int rank, int size, unsigned long long seed, randn_method gen,
+                                  unsigned effort, double t[PH_COUNT], double *sumsq, int *c0_out, int *nc_out) {
+    const int nh = (int)fft2_nh(n);
+    const int r0 = blk_lo(n, rank, size), nr = blk_n(n, rank, size);
+    const int c0 = blk_lo(nh, rank, size), nc = blk_n(nh, rank, size);
+    const size_t stride = 2 * (size_t)nh;   // padded row: n reals in, nh complex out
+
+    // send (dir 0) and receive (dir 1) counts and displacements, in elements
+    a2a_count *scount = malloc(2 * (size_t)size * sizeof(a2a_count)), *rcount = scount + size;
+    a2a_displ *sdispl = malloc(2 * (size_t)size * sizeof(a2a_displ)), *rdispl = sdispl + size;
+    if (!scount || !sdispl) { fprintf(stderr, "rank %d: out of memory\n", rank); MPI_Abort(MPI_COMM_WORLD, 1); }
+    int too_big = 0;
+    for (int dir = 0; dir < 2; ++dir) {
+        long long off = 0;
+        for (int q = 0; q < size; ++q) {
+            long long cnt = dir ? (long long)blk_n(n, q, size) * nc : (long long)nr * blk_n(nh, q, size);
+            too_big |= (sizeof(a2a_count) < 8) && (cnt > INT_MAX || off > INT_MAX);
+            scount[dir * size + q] = (a2a_count)cnt;
+            sdispl[dir * size + q] = (a2a_displ)off;
+            off += cnt;
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &too_big, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (too_big) {
+        if (rank == 0)
+            fprintf(stderr, "n = %d on %d ranks: an Alltoallv block exceeds INT_MAX elements "
+                            "(MPI-%d counts are int); use more ranks or an MPI-4 library\n", n, size, MPI_VERSION);
+        free(scount); free(sdispl);
+        return NULL;
+    }
+
+    // slab buffers, each large enough for the padded rows, the send blocks
+    // (nr x nh) and the columns (nc x n): A = rows, then receive; B = send,
+    // then columns
+    size_t slab = (size_t)nr * nh > (size_t)nc * n ? (size_t)nr * nh : (size_t)nc * n;
+    fftw_complex *bufA = fftw_alloc_complex(slab + 1), *bufB = fftw_alloc_complex(slab + 1);
+    if (!bufA || !bufB) {
+        fprintf(stderr, "rank %d: out of memory\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    double *rows = (double*) bufA;
+    fftw_complex *sendbuf = bufB, *recvbuf = bufA, *cols = bufB;
+
+    // plans first (measuring planners overwrite the buffers)
+    const int len = n;
+    fftw_plan prow = fftw_plan_many_dft_r2c(1, &len, nr, rows, NULL, 1, (int)stride,
+                                            (fftw_complex*) rows, NULL, 1, nh, effort);
+    fftw_plan pcol = fftw_plan_many_dft(1, &len, nc, cols, NULL, 1, n, cols, NULL, 1, n, FFTW_FORWARD, effort);
+    if (!prow || !pcol) { fprintf(stderr, "rank %d: FFTW plan creation failed\n", rank); MPI_Abort(MPI_COMM_WORLD, 1); }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime(), ts = t0;
+    double s2 = 0.0;
+    for (int r = 0; r < nr; ++r) {
+        double *a = rows + (size_t)r * stride;
+        randn_fill(gen, seed, 0, (uint64_t)(r0 + r) * n, (size_t)n, 1.0, 1.0, a);
+        for (int c = 0; c < n; ++c) s2 += a[c] * a[c];
+    }
+    *sumsq = s2;
+    double t1 = MPI_Wtime(); t[PH_GEN] = t1 - t0; t0 = t1;
+
+    fftw_execute(prow);
+    t1 = MPI_Wtime(); t[PH_ROWFFT] = t1 - t0; t0 = t1;
+
+    // block for rank q: my rows x q's columns, row-major
+    const fftw_complex *half = (const fftw_complex*) rows;
+    for (int q = 0; q < size; ++q) {
+        int qc0 = blk_lo(nh, q, size), qnc = blk_n(nh, q, size);
+        fftw_complex *dst = sendbuf + sdispl[q];
+        for (int r = 0; r < nr; ++r)
+            memcpy(dst + (size_t)r * qnc, half + (size_t)r * nh + qc0, (size_t)qnc * sizeof(fftw_complex));
+    }
+    t1 = MPI_Wtime(); t[PH_PACK] = t1 - t0; t0 = t1;
+
+#if MPI_VERSION >= 4
+    MPI_Alltoallv_c(sendbuf, scount, sdispl, MPI_C_DOUBLE_COMPLEX,
+                    recvbuf, rcount, rdispl, MPI_C_DOUBLE_COMPLEX, MPI_COMM_WORLD);
+#else
+    MPI_Alltoallv(sendbuf, scount, sdispl, MPI_C_DOUBLE_COMPLEX,
+                  recvbuf, rcount, rdispl, MPI_C_DOUBLE_COMPLEX, MPI_COMM_WORLD);
+#endif
+    t1 = MPI_Wtime(); t[PH_ALLTOALL] = t1 - t0; t0 = t1;
+
+    // block from rank p: p's rows x my columns -> columns of length n
+    for (int p = 0; p < size; ++p) {
+        int pr0 = blk_lo(n, p, size), pnr = blk_n(n, p, size);
+        const fftw_complex *src = recvbuf + rdispl[p];
+        for (int r = 0; r < pnr; ++r)
+            for (int j = 0; j < nc; ++j) {
+                cols[(size_t)j * n + pr0 + r][0] = src[(size_t)r * nc + j][0];
+                cols[(size_t)j * n + pr0 + r][1] = src[(size_t)r * nc + j][1];
+            }
+    }
+    t1 = MPI_Wtime(); t[PH_UNPACK] = t1 - t0; t0 = t1;
+
+    fftw_execute(pcol);
+    t1 = MPI_Wtime(); t[PH_COLFFT] = t1 - t0;
+    t[PH_TOTAL] = t1 - ts;
+
+    fftw_destroy_plan(prow);
+    fftw_destroy_plan(pcol);
+    fftw_free(bufA);
+    free(scount);
+    free(sdispl);
+    *c0_out = c0;
+    *nc_out = nc;
+    return cols;
+}
+
+#ifdef USE_FFTW_MPI
+// Same slabs through FFTW-MPI; output in the same transposed layout.
+static fftw_complex *fft2_fftw_mpi(int n, int rank, unsigned long long seed, randn_method gen,
+                                   unsigned effort, double t[PH_COUNT], double *sumsq, int *c0_out, int *nc_out) {
+    const ptrdiff_t nh = (ptrdiff_t)fft2_nh(n);
+    ptrdiff_t nr, r0, nc, c0;
+    ptrdiff_t alloc = fftw_mpi_local_size_2d_transposed(n, nh, MPI_COMM_WORLD, &nr, &r0, &nc, &c0);
+    double *buf = fftw_alloc_real(2 * (size_t)alloc + 1);
+    if (!buf) { fprintf(stderr, "rank %d: out of memory\n", rank); MPI_Abort(MPI_COMM_WORLD, 1); }
+    fftw_plan p = fftw_mpi_plan_dft_r2c_2d(n, n, buf, (fftw_complex*) buf, MPI_COMM_WORLD,
+                                           effort | FFTW_MPI_TRANSPOSED_OUT);
+    if (!p) { fprintf(stderr, "rank %d: FFTW-MPI plan creation failed\n", rank); MPI_Abort(MPI_COMM_WORLD, 1); }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime(), s2 = 0.0;
+    for (ptrdiff_t r = 0; r < nr; ++r) {
+        double *a = buf + (size_t)r * 2 * (size_t)nh;
+        randn_fill(gen, seed, 0, (uint64_t)(r0 + r) * n, (size_t)n, 1.0, 1.0, a);
+        for (int c = 0; c < n; ++c) s2 += a[c] * a[c];
+    }
+    *sumsq = s2;
+    double t1 = MPI_Wtime();
+    t[PH_GEN] = t1 - t0;
+    fftw_execute(p);
+    t[PH_TOTAL] = MPI_Wtime() - t0;
+    fftw_destroy_plan(p);
+    *c0_out = (int)c0;
+    *nc_out = (int)nc;
+    return (fftw_complex*) buf;
+}
+#endif
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#ifdef USE_FFTW_MPI
+    fftw_mpi_init();
+#endif
+
+    const char *path = (argc > 1) ? argv[1] : "builtin";
+    int n = (argc > 2) ? atoi(argv[2]) : 1000;
+    unsigned long long seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (unsigned long long)time(NULL);
+    MPI_Bcast(&seed, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);   // time(NULL) may differ per rank
+    randn_method gen = (argc > 4 && argv[4][0] == 'z') ? RANDN_ZIGGURAT : RANDN_BOXMULLER;
+    unsigned effort = FFTW_ESTIMATE;
+    int bad = (argc > 5 && fft2_effort(argv[5], &effort) != 0) || n < 2 || size > n / 2 + 1;
+    int fftw = (strcmp(path, "fftw") == 0);
+    if (!fftw && strcmp(path, "builtin") != 0) bad = 1;
+#ifndef USE_FFTW_MPI
+    if (fftw) {
+        if (rank == 0) fprintf(stderr, "Rebuild with -DUSE_FFTW_MPI (and -lfftw3_mpi) for the fftw path.\n");
+        MPI_Finalize();
+        return 1;
+    }
+#endif
+    if (bad) {
+        if (rank == 0) fprintf(stderr, "Usage: mpirun -np P %s [builtin|fftw] [n] [seed] [bm|zig] "
+                                       "[estimate|measure|patient|exhaustive]  (P <= n/2+1)\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    double t[PH_COUNT] = { 0 }, sumsq = 0.0;
+    int c0 = 0, nc = 0;
+    fftw_complex *cols;
+#ifdef USE_FFTW_MPI
+    if (fftw) cols = fft2_fftw_mpi(n, rank, seed, gen, effort, t, &sumsq, &c0, &nc);
+    else
+#endif
+    cols = fft2_builtin(n, rank, size, seed, gen, effort, t, &sumsq, &c0, &nc);
+    if (!cols) {
+        MPI_Finalize();
+        return 1;
+    }
+
+    double spot[6], energy, all_spot[6], all_energy, all_sumsq, tmax[PH_COUNT];
+    local_checks(cols, n, c0, nc, spot, &energy);
+    MPI_Reduce(spot, all_spot, 6, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&energy, &all_energy, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&sumsq, &all_sumsq, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(t, tmax, PH_COUNT, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    int ok = 1;
+    if (rank == 0) {
+        const int want[3][2] = { {0, 0}, {0, 1}, {1, n - 1} };
+        for (int k = 0; k < 3; ++k)
+            printf("C[%d,%d] = %.6e + %.6ei\n", want[k][0], want[k][1], all_spot[2 * k], all_spot[2 * k + 1]);
+        double ref = (double)n * n * all_sumsq, rel = fabs(all_energy - ref) / ref;
+        ok = rel < 1e-10;
+        printf("[CHECK] Parseval sum|C|^2 = n^2 sum A^2: rel diff %.3e  %s\n", rel, ok ? "OK" : "FAIL");
+        printf("[TIME] %s, %d ranks, %dx%d (slowest rank per phase):\n", fftw ? "FFTW-MPI" : "builtin slab",
+               size, n, n);
+        for (int ph = 0; ph < PH_COUNT; ++ph)
+            if (tmax[ph] > 0.0 || ph == PH_TOTAL) printf("[TIME]   %-14s %.6f s\n", ph_name[ph], tmax[ph]);
+        if (!fftw)
+            printf("[TIME]   compute (FFTs) %.6f s | transpose (pack + Alltoallv + unpack) %.6f s\n",
+                   tmax[PH_ROWFFT] + tmax[PH_COLFFT], tmax[PH_PACK] + tmax[PH_ALLTOALL] + tmax[PH_UNPACK]);
+    }
+
+    fftw_free(cols);
+#ifdef USE_FFTW_MPI
+    fftw_mpi_cleanup();
+#endif
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// task6b.c
+// Fast convolution / correlation on top of the task6 FFT path (fftconv.h):
+// image = A of task6.c (n x n, N(1,1), Philox stream 0 of the seed),
+// kernel = k x k N(0,1) weights (stream 1), for a sweep of kernel sizes.
+// Requires: libfftw3-dev
+// Build: gcc -O3 -march=native -fno-math-errno -std=c11 task6b.c -o task6b -lfftw3 -lm
+// Run:   ./task6b [n] [seed] [kmax]   (default n = 512, seed = time, kmax = 65)
+//
+// Per kernel size: time of direct, whole-image FFT and overlap-add (best of
+// 3), the method the calibrated cost model picks, and the max deviation of
+// the FFT results from direct. Prints the measured and predicted crossover
+// (smallest k at which an FFT method beats direct), then checks correlation
+// and the same/valid shapes against direct loops.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../common/randn.h"
+#include "fftconv.h"
+
+static const char *meth_name[3] = { "direct", "fft", "ola" };
+
+static double max_abs_diff(const double *a, const double *b, size_t n) {
+    double m = 0.0;
+    for (size_t i = 0; i < n; ++i) if (fabs(a[i] - b[i]) > m) m = fabs(a[i] - b[i]);
+    return m;
+}
+
+static double max_abs(const double *a, size_t n) {
+    double m = 0.0;
+    for (size_t i = 0; i < n; ++i) if (fabs(a[i]) > m) m = fabs(a[i]);
+    return m;
+}
+
+// best-of-reps wall time of conv2d with a fixed method (full shape)
+static double time_conv(const double *img, int n, const double *ker, int k, double *out, conv_method m,
+                        const conv_model *model, int reps) {
+    double best = HUGE_VAL;
+    for (int r = 0; r < reps; ++r) {
+        double t0 = bench_now();
+        conv2d(img, n, n, ker, k, k, out, CONV_FULL, 0, m, model);
+        double t = bench_now() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 512;
+    unsigned long long seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : (unsigned long long)time(NULL);
+    int kmax = (argc > 3) ? atoi(argv[3]) : 65;
+    if (n < 8 || kmax < 3) { fprintf(stderr, "Usage: %s [n >= 8] [seed] [kmax >= 3]\n", argv[0]); return 1; }
+    if (kmax > n) kmax = n;
+
+    const int on = n + kmax - 1;
+    double *img = malloc((size_t)n * n * sizeof(double));
+    double *ker = malloc((size_t)kmax * kmax * sizeof(double));
+    double *ref = malloc((size_t)on * on * sizeof(double));
+    double *out = malloc((size_t)on * on * sizeof(double));
+    if (!img || !ker || !ref || !out) { perror("malloc"); return 1; }
+    randn_fill(RANDN_BOXMULLER, seed, 0, 0, (size_t)n * n, 1.0, 1.0, img);
+
+    conv_model model;
+    conv_calibrate(&model);
+    printf("Cost model (calibrated): direct %.3f ns per multiply-add, FFT %.3f ns per flop\n",
+           model.direct_ns, model.fft_ns);
+    printf("Image %dx%d\n", n, n);
+    printf("%5s %12s %12s %12s %6s %8s %8s %11s %11s\n", "k", "direct [s]", "fft [s]", "ola [s]",
+           "tile", "fastest", "model", "fft err", "ola err");
+
+    int cross_meas = 0, cross_model = 0, ok = 1, direct_on = 1;
+    const int ks[] = { 3, 5, 7, 9, 11, 13, 15, 17, 21, 25, 31, 41, 51, 65, 81, 101, 129, 161, 201, 257 };
+    for (size_t ki = 0; ki < sizeof ks / sizeof ks[0] && ks[ki] <= kmax; ++ki) {
+        const int k = ks[ki];
+        const size_t nout = (size_t)(n + k - 1) * (n + k - 1);
+        randn_fill(RANDN_BOXMULLER, seed, 1, 0, (size_t)k * k, 0.0, 1.0, ker);
+        conv_choice c = conv_choose(&model, n, n, k, k);
+
+        // direct stays the reference until it is far behind; then FFT is
+        double td = HUGE_VAL;
+        if (direct_on) td = time_conv(img, n, ker, k, ref, CONV_DIRECT, &model, 3);
+        double tf = time_conv(img, n, ker, k, out, CONV_FFT, &model, 3);
+        double ef = 0.0, scale = 1.0;
+        if (direct_on) { scale = max_abs(ref, nout); ef = max_abs_diff(out, ref, nout) / scale; }
+        else { memcpy(ref, out, nout * sizeof(double)); scale = max_abs(ref, nout); }
+        conv_model only_fft = { HUGE_VAL, model.fft_ns };
+        conv_choice t = conv_choose(&only_fft, n, n, k, k);
+        double to = HUGE_VAL, eo = 0.0;
+        if (t.method == CONV_OLA) {
+            to = time_conv(img, n, ker, k, out, CONV_OLA, &model, 3);
+            eo = max_abs_diff(out, ref, nout) / scale;
+        }
+        if (ef > 1e-12 || eo > 1e-12) ok = 0;
+
+        int fastest = (td <= tf && td <= to) ? CONV_DIRECT : (tf <= to) ? CONV_FFT : CONV_OLA;
+        if (!cross_meas && fastest != CONV_DIRECT) cross_meas = k;
+        if (!cross_model && c.method != CONV_DIRECT) cross_model = k;
+
+        char sd[16] = "-", so[16] = "-", st[16] = "-", seo[16] = "-";
+        if (direct_on) snprintf(sd, sizeof sd, "%.6f", td);
+        if (t.method == CONV_OLA) {
+            snprintf(so, sizeof so, "%.6f", to);
+            snprintf(st, sizeof st, "%d", t.tile);
+            snprintf(seo, sizeof seo, "%.2e", eo);
+        }
+        printf("%5d %12s %12.6f %12s %6s %8s %8s %11.2e %11s\n", k, sd, tf, so, st, meth_name[fastest],
+               meth_name[c.method], ef, seo);
+        if (direct_on && td > 20.0 * (tf < to ? tf : to)) direct_on = 0;
+    }
+    if (cross_meas) printf("Crossover (measured): FFT beats direct from k = %d\n", cross_meas);
+    else printf("Crossover (measured): direct fastest up to k = %d\n", kmax);
+    if (cross_model) printf("Crossover (model):    FFT predicted faster from k = %d\n", cross_model);
+    else printf("Crossover (model):    direct predicted fastest up to k = %d\n", kmax);
+    printf("[CHECK] fft and ola vs direct (max |diff| / max |direct| < 1e-12): %s\n", ok ? "OK" : "FAIL");
+
+    // correlation and output shapes, k = 7 against plain loops
+    const int k = 7, sh = (k - 1) / 2;
+    randn_fill(RANDN_BOXMULLER, seed, 1, 0, (size_t)k * k, 0.0, 1.0, ker);
+    double *same = malloc((size_t)n * n * sizeof(double));
+    double *valid = malloc((size_t)(n - k + 1) * (n - k + 1) * sizeof(double));
+    if (!same || !valid) { perror("malloc"); return 1; }
+    double e_corr = 0.0, e_same = 0.0, e_valid = 0.0, s = 0.0;
+    conv2d(img, n, n, ker, k, k, out, CONV_FULL, 1, CONV_FFT, &model);    // correlation, full
+    conv2d(img, n, n, ker, k, k, same, CONV_SAME, 0, CONV_OLA, &model);   // convolution, same
+    conv2d(img, n, n, ker, k, k, valid, CONV_VALID, 0, CONV_AUTO, &model);
+    for (int i = 0; i < n + k - 1; ++i)
+        for (int j = 0; j < n + k - 1; ++j) {
+            double corr = 0.0, conv = 0.0;   // correlation at shift (i-k+1, j-k+1), convolution at (i, j)
+            for (int u = 0; u < k; ++u)
+                for (int v = 0; v < k; ++v) {
+                    int y = i - k + 1 + u, x = j - k + 1 + v;
+                    if (y >= 0 && y < n && x >= 0 && x < n) corr += img[(size_t)y * n + x] * ker[u * k + v];
+                    y = i - u; x = j - v;
+                    if (y >= 0 && y < n && x >= 0 && x < n) conv += img[(size_t)y * n + x] * ker[u * k + v];
+                }
+            if (fabs(corr) > s) s = fabs(corr);
+            double d = fabs(out[(size_t)i * (n + k - 1) + j] - corr);
+            if (d > e_corr) e_corr = d;
+            if (i >= sh && i < sh + n && j >= sh && j < sh + n) {
+                d = fabs(same[(size_t)(i - sh) * n + j - sh] - conv);
+                if (d > e_same) e_same = d;
+            }
+            if (i >= k - 1 && i < n && j >= k - 1 && j < n) {
+                d = fabs(valid[(size_t)(i - k + 1) * (n - k + 1) + j - k + 1] - conv);
+                if (d > e_valid) e_valid = d;
+            }
+        }
+    int ok2 = e_corr / s < 1e-12 && e_same / s < 1e-12 && e_valid / s < 1e-12;
+    printf("[CHECK] k=%d correlation (fft) %.2e | same (ola) %.2e | valid (auto) %.2e  %s\n", k, e_corr / s,
+           e_same / s, e_valid / s, ok2 ? "OK" : "FAIL");
+
+    free(img); free(ker); free(ref); free(out); free(same); free(valid);
+    return (ok && ok2) ? 0 : 1;
+}
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <time.h>
 
+#include "../common/sumlib.h"
+
 static inline double dabs(double v){ return v < 0 ? -v : v; }
 
 bool arrays_allclose(const double *a, const double *b, size_t n, double rtol, double atol){
@@ -15,10 +17,9 @@ bool arrays_allclose(const double *a, const double *b, size_t n, double rtol, do
     return true;
 }
 
+// Compensated (multi-lane Neumaier) sum, see ../common/sumlib.h
 double sum_array(const double *a, size_t n){
-    double s = 0.0;
-    for(size_t i=0;i<n;++i) s += a[i];
-    return s;
+    return sum_neumaier_simd(a, n);
 }
 
 // Reference: single-loop daxpy: d[i] = a*x[i] + y[i]
@@ -40,12 +41,10 @@ void daxpy_chunked(double a, const double *x, const double *y,
         size_t end   = start + chunk_size;
         if (end > n) end = n;
 
-        double local_sum = 0.0;
         for(size_t i=start;i<end;++i){
             d[i] = a*x[i] + y[i];
-            local_sum += d[i];
         }
-        partial_chunk_sum[k] = local_sum;
+        partial_chunk_sum[k] = sum_array(d + start, end - start);
     }
 }
 
@@ -110,4 +109,5 @@ int main(void){
     return same && (sum_diff <= 1e-12 * (1.0 + fabs(sum_single))) ? 0 : 1;
 }
 // Output: [CHECK] d(single) == d(chunked)? YES
-// [CHECK] sum(partials)=13.552160067275240  sum(d_single)=13.552160067275242  |diff|=1.776e-15  => MATCH
\ No newline at end of file
+// [CHECK] sum(partials)=13.552160067275242  sum(d_single)=13.552160067275242  |diff|=0.000e+00  => MATCH
+// (with the naive sums this was sum(partials)=13.552160067275240, |diff|=1.776e-15)
\ No newline at end of file
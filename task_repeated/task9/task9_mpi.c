@@ -1,5 +1,21 @@
 // task9_mpi.c
 // This program scatters x,y across ranks, computes local d = x + y,
+// Usage: mpirun -np P ./task9_mpi [N] [comp|plain|repro|exact]
+//   comp  : each rank sums its slice with multi-lane Neumaier
+//           (../common/sumlib.h); the (sum, compensation) pairs are
+//           gathered and merged in rank order on rank 0 (default)
+//   plain : sum(d) with MPI_Reduce(MPI_SUM)   (bits depend on P)
+//   repro : ranks own whole blocks of ../common/repro_sum.h, block sums
+//           are gathered and combined with a fixed tree (same bits for any P)
+//   exact : each rank fills a superaccumulator (../common/exactsum.h), the
+//           limb arrays are gathered and merged exactly on rank 0; the
+//           result is the correctly rounded sum (same bits for any P)
+//
+// Benchmark mode (sweeps rank counts 1,2,4,..,P inside one mpirun):
+//   mpirun -np P ./task9_mpi bench strong|weak [sizes] [reps] [out_prefix]
+//   sizes: comma list; strong = total N, weak = N per rank (default 1e7)
+//   kernels: "add" (local d = x + y) and "add+allreduce" (plus sum(d));
+//   time of a repetition = slowest rank. Writes <out_prefix>.csv/.json.
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,31 +23,164 @@
 #include <string.h>
 #include <mpi.h>
 
+#include "../common/repro_sum.h"
+#include "../common/sumlib.h"
+#include "../common/exactsum.h"
+#include "../common/bench.h"
+#include "../common/cbrng.h"
+
 static inline int approx_equal(double a, double b, double rtol, double atol) {
     double diff = fabs(a - b);
     return diff <= (atol + rtol * fabs(b));
 }
 
-// fill arrays deterministically like in OpenMP program
-static void fill_xy(double *x, double *y, size_t N) {
-    unsigned long long seed = 42;
-    for (size_t i = 0; i < N; ++i) {
-        seed = seed * 2862933555777941757ULL + 3037000493ULL;
-        double rx = (double)(seed >> 33) / (double)(1ULL<<31);
-        x[i] = rx - 1.0;
-        seed = seed * 2862933555777941757ULL + 3037000493ULL;
-        double ry = (double)(seed >> 33) / (double)(1ULL<<31);
-        y[i] = ry - 1.0;
+// fill elements [first, first+n) of the same x, y as the OpenMP program
+// (Philox counter i -> x[i], y[i]; see ../common/cbrng.h)
+static void fill_xy(double *x, double *y, size_t first, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t wx, wy;
+        cbrng_bits(42, 0, first + i, &wx, &wy);
+        x[i] = 2.0 * cbrng_u01(wx) - 1.0;
+        y[i] = 2.0 * cbrng_u01(wy) - 1.0;
     }
 }
 
+// ---- Scaling benchmark: sub-communicators of the first p ranks ----
+static int run_bench(int argc, char **argv, int rank, int size) {
+    const char *scaling = (argc > 1) ? argv[1] : "strong";
+    const char *sizes   = (argc > 2) ? argv[2] : "1e7";
+    int reps            = (argc > 3) ? atoi(argv[3]) : 10;
+    const char *prefix  = (argc > 4) ? argv[4] : "task9_mpi_bench";
+    const int warmups = 2;
+    int weak = (strcmp(scaling, "weak") == 0);
+    if (!weak && strcmp(scaling, "strong") != 0) {
+        if (rank == 0) fprintf(stderr, "Unknown scaling '%s' (use strong or weak)\n", scaling);
+        return 1;
+    }
+    if (reps < 1) reps = 1;
+
+    size_t nlist[32];
+    int nsizes = bench_parse_sizes(sizes, nlist, 32);
+    if (nsizes == 0) {
+        if (rank == 0) fprintf(stderr, "No sizes in '%s'\n", sizes);
+        return 1;
+    }
+
+    int plist[64], np = 0;
+    for (int p = 1; p < size && np < 63; p *= 2) plist[np++] = p;
+    plist[np++] = size;
+
+    bench_row *rows = (bench_row*) calloc((size_t)nsizes * np * 2, sizeof(bench_row));
+    double *t_add = (double*) malloc((size_t)reps * sizeof(double));
+    double *t_red = (double*) malloc((size_t)reps * sizeof(double));
+    if (!rows || !t_add || !t_red) {
+        fprintf(stderr, "Allocation failed on rank %d.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 6);
+    }
+    int nrows = 0;
+
+    if (rank == 0) {
+        printf("[BENCH] %s scaling, %d reps + %d warm-ups, ranks 1..%d\n",
+               scaling, reps, warmups, size);
+        printf("%-14s ", "kernel");
+        bench_print_header();
+    }
+    for (int s = 0; s < nsizes; ++s) {
+        double ref_add = 0.0, ref_red = 0.0;
+        for (int k = 0; k < np; ++k) {
+            int p = plist[k];
+            size_t N = weak ? nlist[s] * (size_t)p : nlist[s];
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+
+            if (comm != MPI_COMM_NULL) {
+                size_t local_n = N / p + ((size_t)rank < N % p ? 1 : 0);
+                double *x = (double*) aligned_alloc(64, local_n * sizeof(double) + 64);
+                double *y = (double*) aligned_alloc(64, local_n * sizeof(double) + 64);
+                double *d = (double*) aligned_alloc(64, local_n * sizeof(double) + 64);
+                if (!x || !y || !d) {
+                    fprintf(stderr, "Allocation failed on rank %d for N=%zu.\n", rank, N);
+                    MPI_Abort(MPI_COMM_WORLD, 7);
+                }
+                // timing only: every rank fills its own slice of the global
+                // x, y locally (counter-based generator), no scatter
+                size_t first = (size_t)rank * (N / p) + ((size_t)rank < N % p ? (size_t)rank : N % p);
+                fill_xy(x, y, first, local_n);
+
+                for (int r = -warmups; r < reps; ++r) {
+                    MPI_Barrier(comm);
+                    double t0 = MPI_Wtime();
+                    for (size_t i = 0; i < local_n; ++i) d[i] = x[i] + y[i];
+                    double t1 = MPI_Wtime();
+                    double local_sum = 0.0, global_sum = 0.0;
+                    for (size_t i = 0; i < local_n; ++i) local_sum += d[i];
+                    MPI_Allreduce(&local_sum, &global_sum, 1, MPI_DOUBLE, MPI_SUM, comm);
+                    double t2 = MPI_Wtime();
+                    double mine[2] = { t1 - t0, t2 - t0 }, slowest[2];
+                    MPI_Reduce(mine, slowest, 2, MPI_DOUBLE, MPI_MAX, 0, comm);
+                    if (r >= 0) { t_add[r] = slowest[0]; t_red[r] = slowest[1]; }
+                }
+
+                if (rank == 0) {
+                    for (int kk = 0; kk < 2; ++kk) {
+                        bench_row *row = &rows[nrows++];
+                        row->program = "task9_mpi";
+                        row->kernel  = kk ? "add+allreduce" : "add";
+                        row->scaling = scaling;
+                        row->workers = p;
+                        row->n       = N;
+                        row->bytes   = (kk ? 32.0 : 24.0) * (double)N;
+                        bench_stats_compute(kk ? t_red : t_add, reps, &row->t);
+                        row->gbps = row->bytes / row->t.median / 1e9;
+                        double *ref = kk ? &ref_red : &ref_add;
+                        if (p == 1) *ref = row->t.median;
+                        row->efficiency = weak ? *ref / row->t.median
+                                               : *ref / ((double)p * row->t.median);
+                        printf("%-14s ", row->kernel);
+                        bench_print_row(row);
+                    }
+                }
+                free(d); free(y); free(x);
+                MPI_Comm_free(&comm);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+
+    int rc = 0;
+    if (rank == 0) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s.csv", prefix);
+        rc = bench_write_csv(path, rows, nrows);
+        snprintf(path, sizeof(path), "%s.json", prefix);
+        rc |= bench_write_json(path, rows, nrows);
+        if (rc == 0) printf("[BENCH] wrote %s.csv and %s.json\n", prefix, prefix);
+    }
+    free(t_red); free(t_add); free(rows);
+    return rc ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
     int rank = 0, size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        int rc = run_bench(argc - 1, argv + 1, rank, size);
+        MPI_Finalize();
+        return rc;
+    }
+
     size_t N = (argc > 1) ? strtoull(argv[1], NULL, 10) : (size_t)2000000; // default: 2M
+    const char *mode = (argc > 2) ? argv[2] : "comp";
+    int repro = (strcmp(mode, "repro") == 0);
+    int comp  = (strcmp(mode, "comp") == 0);
+    int exact = (strcmp(mode, "exact") == 0);
+    if (!repro && !comp && !exact && strcmp(mode, "plain") != 0) {
+        if (rank == 0) fprintf(stderr, "Unknown reduction mode '%s' (use comp, plain, repro or exact)\n", mode);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
     if (size > 4) {
         if (rank == 0) fprintf(stderr, "Please do not spawn more than 4 tasks for this assignment.\n");
         MPI_Abort(MPI_COMM_WORLD, 1);
@@ -51,7 +200,7 @@ int main(int argc, char** argv) {
             fprintf(stderr, "Allocation failed on rank 0.\n");
             MPI_Abort(MPI_COMM_WORLD, 2);
         }
-        fill_xy(x, y, N);
+        fill_xy(x, y, 0, N);
 
         // Serial baseline on rank 0 (for timing & correctness)
         t0 = MPI_Wtime();
@@ -61,20 +210,30 @@ int main(int argc, char** argv) {
     }
 
     // Compute scatter counts and displacements
+    // (repro: split whole REPRO_BLOCK blocks instead of single elements)
     int *counts = (int*) malloc(size * sizeof(int));
     int *displs = (int*) malloc(size * sizeof(int));
     if (!counts || !displs) {
         fprintf(stderr, "Allocation of counts/displs failed.\n");
         MPI_Abort(MPI_COMM_WORLD, 3);
     }
-    size_t base = N / size;
-    size_t rem  = N % size;
-    size_t offset = 0;
-    for (int r = 0; r < size; ++r) {
-        size_t chunk = base + (r < rem ? 1 : 0);
-        counts[r] = (int)chunk;
-        displs[r] = (int)offset;
-        offset += chunk;
+    if (repro) {
+        for (int r = 0; r < size; ++r) {
+            size_t first, chunk;
+            repro_partition(N, size, r, &first, &chunk);
+            counts[r] = (int)chunk;
+            displs[r] = (int)first;
+        }
+    } else {
+        size_t base = N / size;
+        size_t rem  = N % size;
+        size_t offset = 0;
+        for (int r = 0; r < size; ++r) {
+            size_t chunk = base + (r < rem ? 1 : 0);
+            counts[r] = (int)chunk;
+            displs[r] = (int)offset;
+            offset += chunk;
+        }
     }
 
     size_t local_n = (size_t)counts[rank];
@@ -96,10 +255,69 @@ int main(int argc, char** argv) {
     for (size_t i = 0; i < local_n; ++i) d_local[i] = x_local[i] + y_local[i];
 
     // (Optional) parallel reduction of sum(d)
-    double local_sum = 0.0;
-    for (size_t i = 0; i < local_n; ++i) local_sum += d_local[i];
     double global_sum = 0.0;
-    MPI_Reduce(&local_sum, &global_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (repro) {
+        // each rank sums its own blocks; rank 0 gathers the block sums in
+        // global block order and runs the fixed tree over all of them
+        size_t nb_total = repro_nblocks(N);
+        double *bs_local = (double*) malloc((repro_nblocks(local_n) + 1) * sizeof(double));
+        double *bs_all = (rank == 0) ? (double*) malloc((nb_total + 1) * sizeof(double)) : NULL;
+        int *bcounts = (int*) malloc(size * sizeof(int));
+        int *bdispls = (int*) malloc(size * sizeof(int));
+        if (!bs_local || (rank == 0 && !bs_all) || !bcounts || !bdispls) {
+            fprintf(stderr, "Allocation of block sums failed on rank %d.\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 5);
+        }
+        for (int r = 0; r < size; ++r) {
+            bcounts[r] = (int)repro_nblocks((size_t)counts[r]);
+            bdispls[r] = displs[r] / REPRO_BLOCK;
+        }
+        size_t nb_local = repro_block_sums(d_local, local_n, bs_local);
+        MPI_Gatherv(bs_local, (int)nb_local, MPI_DOUBLE, bs_all, bcounts, bdispls, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rank == 0) global_sum = repro_tree(bs_all, nb_total);
+        free(bdispls); free(bcounts); free(bs_all); free(bs_local);
+    } else if (comp) {
+        sum_acc local = sum_neumaier_acc(d_local, local_n);
+        double mine[2] = { local.s, local.c };
+        double *all = (rank == 0) ? (double*) malloc(2 * (size_t)size * sizeof(double)) : NULL;
+        if (rank == 0 && !all) MPI_Abort(MPI_COMM_WORLD, 5);
+        MPI_Gather(mine, 2, MPI_DOUBLE, all, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            sum_acc acc = { 0.0, 0.0 };
+            for (int r = 0; r < size; ++r) {
+                sum_acc part = { all[2 * r], all[2 * r + 1] };
+                sum_acc_merge(&acc, part);
+            }
+            global_sum = acc.s + acc.c;
+        }
+        free(all);
+    } else if (exact) {
+        // carried limbs are < 2^32, so summing them over any P cannot overflow
+        // (only the limbs travel: inf/nan in d would be dropped, d is finite here)
+        xsum_large *acc = (xsum_large*) malloc(sizeof(xsum_large));
+        int64_t *all = (rank == 0) ? (int64_t*) malloc((size_t)size * XSUM_LIMBS * sizeof(int64_t)) : NULL;
+        if (!acc || (rank == 0 && !all)) MPI_Abort(MPI_COMM_WORLD, 5);
+        xsum_large_init(acc);
+        xsum_large_add_array(acc, d_local, local_n);
+        xsum_small *mine = xsum_large_small(acc);
+        xsum_small_carry(mine);
+        MPI_Gather(mine->limb, XSUM_LIMBS, MPI_INT64_T, all, XSUM_LIMBS, MPI_INT64_T, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            xsum_small total, part;
+            xsum_small_init(&total);
+            for (int r = 0; r < size; ++r) {
+                xsum_small_init(&part);
+                memcpy(part.limb, all + (size_t)r * XSUM_LIMBS, sizeof(part.limb));
+                xsum_small_merge(&total, &part);
+            }
+            global_sum = xsum_small_round(&total);
+        }
+        free(all); free(acc);
+    } else {
+        double local_sum = 0.0;
+        for (size_t i = 0; i < local_n; ++i) local_sum += d_local[i];
+        MPI_Reduce(&local_sum, &global_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
 
     // Gather results to rank 0
     MPI_Gatherv(d_local, counts[rank], MPI_DOUBLE, d_gather, counts, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
@@ -116,12 +334,29 @@ int main(int argc, char** argv) {
         printf("[CHECK] max |d_serial - d_mpi| = %.3e => %s\n",
                max_abs_diff, (max_abs_diff <= 1e-12 ? "OK" : "MISMATCH"));
 
-        // Reduction check
+        // Reduction check (repro/exact: must be bit-identical to the serial sum)
         double serial_sum = 0.0;
-        for (size_t i = 0; i < N; ++i) serial_sum += d_serial[i];
-        printf("[CHECK] sum(d) serial=%.15f  mpi=%.15f  => %s\n",
-               serial_sum, global_sum,
-               approx_equal(serial_sum, global_sum, 1e-12, 0.0) ? "MATCH" : "MISMATCH");
+        if (repro) {
+            double *bs = (double*) malloc((repro_nblocks(N) + 1) * sizeof(double));
+            if (!bs) { fprintf(stderr, "Allocation failed on rank 0.\n"); MPI_Abort(MPI_COMM_WORLD, 2); }
+            size_t nb = repro_block_sums(d_serial, N, bs);
+            serial_sum = repro_tree(bs, nb);
+            free(bs);
+            printf("[CHECK] sum(d) serial=%.15f  mpi=%.15f  => %s\n",
+                   serial_sum, global_sum,
+                   (serial_sum == global_sum) ? "IDENTICAL" : "MISMATCH");
+        } else if (exact) {
+            serial_sum = xsum_exact(d_serial, N);
+            printf("[CHECK] sum(d) serial=%.15f  mpi=%.15f  => %s\n",
+                   serial_sum, global_sum,
+                   (serial_sum == global_sum) ? "IDENTICAL" : "MISMATCH");
+        } else {
+            if (comp) serial_sum = sum_neumaier_simd(d_serial, N);
+            else for (size_t i = 0; i < N; ++i) serial_sum += d_serial[i];
+            printf("[CHECK] sum(d) serial=%.15f  mpi=%.15f  => %s\n",
+                   serial_sum, global_sum,
+                   approx_equal(serial_sum, global_sum, 1e-12, 0.0) ? "MATCH" : "MISMATCH");
+        }
 
         // Timing
         printf("[TIME] serial (rank0): %.6f s | mpi (np=%d): %.6f s\n",
@@ -1,6 +1,32 @@
 // task9_openmp.c
 // This program computes d = x + y and compares OpenMP vs serial.
+// Usage: ./task9_openmp [N] [comp|plain|repro|exact]
+//   comp  : sum(d) with multi-lane Neumaier (../common/sumlib.h, default)
+//   plain : sum(d) with reduction(+:...)   (bits depend on thread count)
+//   repro : sum(d) with fixed-block pairwise tree (same bits for any
+//           thread count, see ../common/repro_sum.h)
+//   exact : correctly rounded sum(d) with a superaccumulator (same bits for
+//           any thread count and any order, see ../common/exactsum.h)
+//   comp and repro rely on IEEE rounding: build without -ffast-math, e.g.
+//   gcc -O3 -march=native -fopenmp -std=c11 task9_openmp.c -o task9_openmp -lm
+// Threads are bound with proc_bind(spread); pick the places with e.g.
+//   OMP_PLACES=cores ./task9_openmp 100000000
+// The comp/repro/exact reductions run in the ../common parallel regions,
+// which follow OMP_PROC_BIND: set OMP_PROC_BIND=spread as well so the
+// "overhead" line compares them with the plain reduction on the same binding.
+// x, y, d_omp are first-touched by the same static schedule as the compute
+// loop, so each thread's pages live on its own NUMA node.
+//
+// Benchmark mode (sweeps thread counts 1,2,4,..,OMP_NUM_THREADS):
+//   ./task9_openmp bench strong|weak [sizes] [reps] [out_prefix]
+//   sizes: comma list; strong = total N, weak = N per thread (default 1e7)
+//   writes <out_prefix>.csv and <out_prefix>.json (default task9_openmp_bench)
+//
+// Hardware counters (../common/perfctr.h): build with -DUSE_PERFCTR to get a
+// [PERF] line (IPC, LLC / dTLB misses, DRAM bytes per element) after each
+// [TIME] line of the add loops; timing only where counters are unavailable.
 
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -8,21 +34,141 @@
 #include <time.h>
 #include <string.h>
 
+#include "../common/repro_sum.h"
+#include "../common/sumlib.h"
+#include "../common/exactsum.h"
+#include "../common/bench.h"
+#include "../common/cbrng.h"
+#include "../common/perfctr.h"
+
+#define RED_REPS 5   // timed rounds of the sum(d) reductions (best is reported)
+
 static inline double now_sec(void) {
     return omp_get_wtime(); // high-res wall clock
 }
 
+// Parallel first-touch fill. x[i], y[i] come from Philox counter i
+// (../common/cbrng.h), so any thread can make any element: the values do not
+// depend on the thread count. schedule(static) over the same N gives the
+// same chunks as the compute loop.
+static void fill_xy(double *x, double *y, size_t N, unsigned long long seed) {
+    #pragma omp parallel for schedule(static) proc_bind(spread)
+    for (size_t i = 0; i < N; ++i) {
+        uint64_t wx, wy;
+        cbrng_bits(seed, 0, i, &wx, &wy);
+        x[i] = 2.0 * cbrng_u01(wx) - 1.0; // (-1,1)
+        y[i] = 2.0 * cbrng_u01(wy) - 1.0;
+    }
+}
+
 static inline int approx_equal(double a, double b, double rtol, double atol) {
     double diff = fabs(a - b);
     return diff <= (atol + rtol * fabs(b));
 }
 
+// ---- Scaling benchmark: d = x + y, repeated, for each thread count ----
+static int run_bench(int argc, char **argv) {
+    const char *scaling = (argc > 1) ? argv[1] : "strong";
+    const char *sizes   = (argc > 2) ? argv[2] : "1e7";
+    int reps            = (argc > 3) ? atoi(argv[3]) : 10;
+    const char *prefix  = (argc > 4) ? argv[4] : "task9_openmp_bench";
+    const int warmups = 2;
+    int weak = (strcmp(scaling, "weak") == 0);
+    if (!weak && strcmp(scaling, "strong") != 0) {
+        fprintf(stderr, "Unknown scaling '%s' (use strong or weak)\n", scaling);
+        return 1;
+    }
+    if (reps < 1) reps = 1;
+
+    size_t nlist[32];
+    int nsizes = bench_parse_sizes(sizes, nlist, 32);
+    if (nsizes == 0) { fprintf(stderr, "No sizes in '%s'\n", sizes); return 1; }
+
+    int max_threads = omp_get_max_threads();
+    int tlist[64], nt = 0;
+    for (int t = 1; t < max_threads && nt < 63; t *= 2) tlist[nt++] = t;
+    tlist[nt++] = max_threads;
+
+    bench_row *rows = (bench_row*) calloc((size_t)nsizes * nt, sizeof(bench_row));
+    double *samples = (double*) malloc((size_t)reps * sizeof(double));
+    if (!rows || !samples) { fprintf(stderr, "Allocation failed.\n"); return 1; }
+    int nrows = 0;
+
+    printf("[BENCH] %s scaling, %d reps + %d warm-ups, threads 1..%d\n",
+           scaling, reps, warmups, max_threads);
+    bench_print_header();
+    for (int s = 0; s < nsizes; ++s) {
+        double t_ref = 0.0;
+        for (int k = 0; k < nt; ++k) {
+            int p = tlist[k];
+            size_t N = weak ? nlist[s] * (size_t)p : nlist[s];
+            omp_set_num_threads(p);
+
+            double *x = (double*) aligned_alloc(64, N * sizeof(double));
+            double *y = (double*) aligned_alloc(64, N * sizeof(double));
+            double *d = (double*) aligned_alloc(64, N * sizeof(double));
+            if (!x || !y || !d) {
+                fprintf(stderr, "Allocation failed for N=%zu.\n", N);
+                free(x); free(y); free(d);
+                break;
+            }
+            fill_xy(x, y, N, 42);
+            for (int r = -warmups; r < reps; ++r) {
+                double t0 = now_sec();
+                #pragma omp parallel for schedule(static) proc_bind(spread)
+                for (size_t i = 0; i < N; ++i) d[i] = x[i] + y[i];
+                double t1 = now_sec();
+                if (r >= 0) samples[r] = t1 - t0;
+            }
+
+            bench_row *row = &rows[nrows++];
+            row->program = "task9_openmp";
+            row->kernel  = "add";
+            row->scaling = scaling;
+            row->workers = p;
+            row->n       = N;
+            row->bytes   = 24.0 * (double)N;   // read x,y + write d
+            bench_stats_compute(samples, reps, &row->t);
+            row->gbps = row->bytes / row->t.median / 1e9;
+            if (p == 1) t_ref = row->t.median;
+            // strong: T1 / (p * Tp), weak: T1 / Tp (work per thread fixed)
+            row->efficiency = weak ? t_ref / row->t.median
+                                   : t_ref / ((double)p * row->t.median);
+            bench_print_row(row);
+
+            free(d); free(y); free(x);
+        }
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.csv", prefix);
+    int rc = bench_write_csv(path, rows, nrows);
+    snprintf(path, sizeof(path), "%s.json", prefix);
+    rc |= bench_write_json(path, rows, nrows);
+    if (rc == 0) printf("[BENCH] wrote %s.csv and %s.json\n", prefix, prefix);
+
+    free(samples);
+    free(rows);
+    return rc ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) return run_bench(argc - 1, argv + 1);
+
     // ---- Input size ----
     size_t N = (argc > 1) ? strtoull(argv[1], NULL, 10) : (size_t)5e6; // default: 5 million
+    const char *mode = (argc > 2) ? argv[2] : "comp";
     int do_reduction = 1; // set 0 to skip sum(d)
+    int repro = (strcmp(mode, "repro") == 0);
+    int comp  = (strcmp(mode, "comp") == 0);
+    int exact = (strcmp(mode, "exact") == 0);
+    if (!repro && !comp && !exact && strcmp(mode, "plain") != 0) {
+        fprintf(stderr, "Unknown reduction mode '%s' (use comp, plain, repro or exact)\n", mode);
+        return 1;
+    }
 
-    printf("N = %zu\n", N);
+    printf("N = %zu  reduction = %s\n", N, mode);
+    perfctr_init(); // before the first parallel region: workers inherit the counters
 
     // ---- Allocate ----
     double *x = (double*) aligned_alloc(64, N * sizeof(double));
@@ -35,39 +181,59 @@ int main(int argc, char** argv) {
     }
 
     // ---- Initialize reproducibly ----
-    // keep data identical across runs
-    unsigned long long seed = 42;
-    for (size_t i = 0; i < N; ++i) {
-        // simple LCG
-        seed = seed * 2862933555777941757ULL + 3037000493ULL;
-        double rx = (double)(seed >> 33) / (double)(1ULL<<31); // [0,2)
-        x[i] = rx - 1.0; // [-1,1)
-        seed = seed * 2862933555777941757ULL + 3037000493ULL;
-        double ry = (double)(seed >> 33) / (double)(1ULL<<31);
-        y[i] = ry - 1.0;
-    }
+    // keep data identical across runs (and across thread counts)
+    fill_xy(x, y, N, 42);
+
+    // first touch of the outputs outside the timed regions
+    memset(d_serial, 0, N * sizeof(double));
+    #pragma omp parallel for schedule(static) proc_bind(spread)
+    for (size_t i = 0; i < N; ++i) d_omp[i] = 0.0;
 
     // ---- Serial baseline ----
+    perfctr_region pc_serial, pc_omp;
+    perfctr_begin(&pc_serial);
     double t0 = now_sec();
     for (size_t i = 0; i < N; ++i) {
         d_serial[i] = x[i] + y[i];
     }
     double t1 = now_sec();
+    perfctr_end(&pc_serial);
     double serial_time = t1 - t0;
 
     // Optional serial reduction
+    // (repro: same blocked tree as the parallel one, computed on one thread)
     double serial_sum = 0.0;
     if (do_reduction) {
-        for (size_t i = 0; i < N; ++i) serial_sum += d_serial[i];
+        if (repro) {
+            double *bs = (double*) malloc(repro_nblocks(N) * sizeof(double));
+            if (!bs) { fprintf(stderr, "Allocation failed.\n"); return 1; }
+            size_t nb = repro_block_sums(d_serial, N, bs);
+            serial_sum = repro_tree(bs, nb);
+            free(bs);
+        } else if (comp) {
+            serial_sum = sum_neumaier_simd(d_serial, N);
+        } else if (exact) {
+            serial_sum = xsum_exact(d_serial, N);
+        } else {
+            for (size_t i = 0; i < N; ++i) serial_sum += d_serial[i];
+        }
     }
 
     // ---- OpenMP parallel ----
+    // untimed warm-up: spins up the thread team and fills the TLBs
+    #pragma omp parallel for schedule(static) proc_bind(spread)
+    for (size_t i = 0; i < N; ++i) {
+        d_omp[i] = x[i] + y[i];
+    }
+
+    perfctr_begin(&pc_omp);
     double t2 = now_sec();
-    #pragma omp parallel for schedule(static)
+    #pragma omp parallel for schedule(static) proc_bind(spread)
     for (size_t i = 0; i < N; ++i) {
         d_omp[i] = x[i] + y[i];
     }
     double t3 = now_sec();
+    perfctr_end(&pc_omp);
     double omp_time = t3 - t2;
 
     // Check correctness elementwise (cheap probe on a few positions + a norm)
@@ -80,28 +246,63 @@ int main(int argc, char** argv) {
     printf("[CHECK] max |d_serial - d_omp| = %.3e => %s\n",
            max_abs_diff, (max_abs_diff <= 1e-12 ? "OK" : "MISMATCH"));
 
-    // Optional OpenMP reduction on d_omp
+    // Optional OpenMP reduction on d_omp: plain and mode reductions take
+    // turns, one untimed round first, best of RED_REPS rounds is reported
     double omp_sum = 0.0;
+    double plain_red_time = INFINITY, mode_red_time = INFINITY;
     if (do_reduction) {
-        #pragma omp parallel for reduction(+:omp_sum) schedule(static)
-        for (size_t i = 0; i < N; ++i) {
-            omp_sum += d_omp[i];
+        int has_mode = repro || comp || exact;
+        for (int rep = -1; rep < RED_REPS; ++rep) {
+            double plain_sum = 0.0;
+            double r0 = now_sec();
+            #pragma omp parallel for reduction(+:plain_sum) schedule(static) proc_bind(spread)
+            for (size_t i = 0; i < N; ++i) {
+                plain_sum += d_omp[i];
+            }
+            double dt = now_sec() - r0;
+            if (rep >= 0 && dt < plain_red_time) plain_red_time = dt;
+            omp_sum = plain_sum;
+            if (!has_mode) continue;
+
+            r0 = now_sec();
+            omp_sum = repro ? repro_sum(d_omp, N) : exact ? xsum_exact_omp(d_omp, N) : sum_neumaier_omp(d_omp, N);
+            dt = now_sec() - r0;
+            if (rep >= 0 && dt < mode_red_time) mode_red_time = dt;
+        }
+
+        if (repro || exact) {
+            // repro and exact must match the serial sum bit for bit, no tolerance
+            printf("[CHECK] sum(d) serial=%.15f  openmp=%.15f  => %s\n",
+                   serial_sum, omp_sum,
+                   (serial_sum == omp_sum) ? "IDENTICAL" : "MISMATCH");
+        } else {
+            printf("[CHECK] sum(d) serial=%.15f  openmp=%.15f  => %s\n",
+                   serial_sum, omp_sum,
+                   approx_equal(serial_sum, omp_sum, 1e-12, 0.0) ? "MATCH" : "MISMATCH");
         }
-        printf("[CHECK] sum(d) serial=%.15f  openmp=%.15f  => %s\n",
-               serial_sum, omp_sum,
-               approx_equal(serial_sum, omp_sum, 1e-12, 0.0) ? "MATCH" : "MISMATCH");
     }
 
     // ---- Timing ----
     int threads = 1;
-    #pragma omp parallel
+    #pragma omp parallel proc_bind(spread)
     {
         #pragma omp single
         threads = omp_get_num_threads();
     }
+    const char *places = getenv("OMP_PLACES");
+    printf("[BIND] proc_bind=spread  places=%d (OMP_PLACES=%s)\n",
+           omp_get_num_places(), places ? places : "unset");
     printf("[TIME] serial: %.6f s | openmp (%d threads): %.6f s | speedup: %.2fx\n",
            serial_time, threads, omp_time,
            (omp_time > 0.0 ? serial_time / omp_time : 0.0));
+    // d = x + y: 2 loads + 1 store of 8 B per element
+    perfctr_print("add serial", &pc_serial, (double)N, 24.0);
+    perfctr_print("add openmp", &pc_omp, (double)N, 24.0);
+    if (do_reduction && (repro || comp || exact)) {
+        printf("[TIME] sum(d) plain: %.6f s | %s: %.6f s | overhead: %+.1f%% (best of %d)\n",
+               plain_red_time, mode, mode_red_time,
+               (plain_red_time > 0.0 ? 100.0 * (mode_red_time / plain_red_time - 1.0) : 0.0), RED_REPS);
+    }
 
     free(d_omp);
     free(d_serial);